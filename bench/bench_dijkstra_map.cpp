@@ -0,0 +1,176 @@
+/*
+ * Benchmark of a monster turn: 300 monsters chase the player on a 256x256
+ * map with 30% random walls. Either every monster runs its own search
+ * (path_find's AStarSearch, grid_search_t), or one dijkstra_map_t is computed
+ * from the player and every monster takes one step downhill.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "dijkstra_map.hpp"
+#include "grid_path_finding.hpp"
+#include "path_finding.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width    = 256;
+constexpr int height   = 256;
+constexpr int monsters = 300;
+constexpr int turns    = 10;
+
+std::vector<bool> walls(width * height);
+
+struct location_t {
+    int x = -1;
+    int y = -1;
+
+    bool operator==(const location_t& rhs) const {
+        return x == rhs.x && y == rhs.y;
+    }
+};
+
+struct navigator {
+    static float get_distance_estimate(location_t& pos, location_t& goal) {
+        const int dx = std::abs(pos.x - goal.x);
+        const int dy = std::abs(pos.y - goal.y);
+        return static_cast<float>(dx + dy)
+               - 0.58578644f * static_cast<float>(std::min(dx, dy));
+    }
+
+    static bool is_goal(location_t& pos, location_t& goal) {
+        return pos == goal;
+    }
+
+    static bool get_successors(location_t pos,
+                               std::vector<location_t>& successors) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dx = -1; dx <= 1; ++dx) {
+                const location_t next{pos.x + dx, pos.y + dy};
+                if((dx != 0 || dy != 0) && is_walkable(next)) {
+                    successors.push_back(next);
+                }
+            }
+        }
+        return true;
+    }
+
+    static float get_cost(location_t& pos, location_t& successor) {
+        return pos.x != successor.x && pos.y != successor.y ? 1.41421356f
+                                                            : 1.f;
+    }
+
+    static bool is_same_state(location_t& lhs, location_t& rhs) {
+        return lhs == rhs;
+    }
+
+    static int get_hash(location_t& loc) {
+        return loc.y * width + loc.x;
+    }
+
+    static int get_x(const location_t& loc) {
+        return loc.x;
+    }
+
+    static int get_y(const location_t& loc) {
+        return loc.y;
+    }
+
+    static location_t get_xy(const int x, const int y) {
+        return location_t{x, y};
+    }
+
+    static bool is_walkable(const location_t& loc) {
+        return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height
+               && !walls[loc.y * width + loc.x];
+    }
+};
+
+// path_find with an allocator large enough for the whole map, allocated once
+location_t astar_step(const location_t& start, const location_t& end) {
+    using node_t = search_node_t<location_t, navigator>;
+    auto a_start = node_t(start);
+    auto a_end   = node_t(end);
+    static AStarSearch<node_t> search(width * height * 8);
+    search.SetStartAndGoalStates(a_start, a_end);
+    unsigned int state = 0;
+    do {
+        state = search.SearchStep();
+    } while(state == AStarSearch<node_t>::kSearchStateSearching);
+    if(state != AStarSearch<node_t>::kSearchStateSucceeded) {
+        return start;
+    }
+    search.GetSolutionStart();
+    const auto* next = search.GetSolutionNext();
+    const location_t step = next ? next->pos : start;
+    search.FreeSolutionNodes();
+    return step;
+}
+
+template <typename F>
+void bench(const char* name, const std::vector<location_t>& start,
+           const location_t& player, F&& turn) {
+    auto positions   = start;
+    const auto begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < turns; ++i) {
+        turn(player, positions);
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - begin;
+    std::printf("%-28s %10.2f ms/turn\n", name, elapsed.count() / turns);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    for(int i = 0; i < width * height; ++i) {
+        walls[i] = rng() % 100 < 30;
+    }
+    const location_t player{width / 2, height / 2};
+    walls[player.y * width + player.x] = false;
+    std::vector<location_t> start;
+    for(int i = 0; i < monsters; ++i) {
+        const location_t monster{static_cast<int>(rng() % width),
+                                 static_cast<int>(rng() % height)};
+        walls[monster.y * width + monster.x] = false;
+        start.push_back(monster);
+    }
+
+    bench("AStarSearch per monster", start, player,
+          [](const location_t& target, std::vector<location_t>& positions) {
+              for(auto& pos : positions) {
+                  pos = astar_step(pos, target);
+              }
+          });
+
+    grid_search_t<location_t, navigator> grid(width, height);
+    std::vector<location_t> steps;
+    bench("grid_search_t per monster", start, player,
+          [&](const location_t& target, std::vector<location_t>& positions) {
+              for(auto& pos : positions) {
+                  if(grid.find(pos, target, steps) && steps.size() > 1) {
+                      pos = steps[1];
+                  }
+              }
+          });
+
+    dijkstra_map_t map(width, height);
+    map.set_costs<location_t, navigator>();
+    bench("dijkstra_map_t, one scan", start, player,
+          [&](const location_t& target, std::vector<location_t>& positions) {
+              map.clear();
+              map.add_source(target.x, target.y);
+              map.compute();
+              for(auto& pos : positions) {
+                  const auto [x, y] = map.downhill(pos.x, pos.y);
+                  pos               = location_t{x, y};
+              }
+          });
+    return 0;
+}
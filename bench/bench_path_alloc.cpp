@@ -0,0 +1,223 @@
+/*
+ * Counts the heap allocations of path_find_into in steady state on a 128x128
+ * map with 30% random walls: global operator new is replaced by a counting
+ * one. A hashed navigator with buffered successors and a reused search and
+ * path must not allocate at all once warmed up, the process exits with 1 if
+ * it does, with or without a path_stats_collector_t recording the searches.
+ * The plain std::vector navigator and the path_find wrapper are printed for
+ * comparison.
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "compact_path.hpp"
+#include "path_finding.hpp"
+#include "path_stats.hpp"
+
+namespace {
+
+size_t allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if(void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+using namespace radl;
+
+namespace {
+
+constexpr int width    = 128;
+constexpr int height   = 128;
+constexpr int searches = 200;
+
+std::vector<bool> walls(width * height);
+
+struct location_t {
+    int x = -1;
+    int y = -1;
+
+    bool operator==(const location_t& rhs) const {
+        return x == rhs.x && y == rhs.y;
+    }
+};
+
+bool is_walkable(const location_t& loc) {
+    return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height
+           && !walls[loc.y * width + loc.x];
+}
+
+struct vector_navigator {
+    static float get_distance_estimate(location_t& pos, location_t& goal) {
+        const int dx = std::abs(pos.x - goal.x);
+        const int dy = std::abs(pos.y - goal.y);
+        return static_cast<float>(dx + dy)
+               - 0.58578644f * static_cast<float>(std::min(dx, dy));
+    }
+
+    static bool is_goal(location_t& pos, location_t& goal) {
+        return pos == goal;
+    }
+
+    static bool get_successors(location_t pos,
+                               std::vector<location_t>& successors) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dx = -1; dx <= 1; ++dx) {
+                const location_t next{pos.x + dx, pos.y + dy};
+                if((dx != 0 || dy != 0) && is_walkable(next)) {
+                    successors.push_back(next);
+                }
+            }
+        }
+        return true;
+    }
+
+    static float get_cost(location_t& pos, location_t& successor) {
+        return pos.x != successor.x && pos.y != successor.y ? 1.41421356f
+                                                            : 1.f;
+    }
+
+    static bool is_same_state(location_t& lhs, location_t& rhs) {
+        return lhs == rhs;
+    }
+
+    static int get_hash(location_t& loc) {
+        return loc.y * width + loc.x;
+    }
+
+    static int get_x(const location_t& loc) {
+        return loc.x;
+    }
+
+    static int get_y(const location_t& loc) {
+        return loc.y;
+    }
+
+    static location_t get_xy(const int x, const int y) {
+        return location_t{x, y};
+    }
+};
+
+struct buffered_navigator : vector_navigator {
+    template <typename successors_t>
+    static bool get_successors(location_t pos, successors_t& successors) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dx = -1; dx <= 1; ++dx) {
+                const location_t next{pos.x + dx, pos.y + dy};
+                if((dx != 0 || dy != 0) && is_walkable(next)) {
+                    successors.push_back(next);
+                }
+            }
+        }
+        return true;
+    }
+};
+
+using pairs_t = std::vector<std::pair<location_t, location_t>>;
+
+// Runs every pair twice: the first pass grows the buffers, the second is
+// counted. Returns the allocations per search of the second pass.
+template <typename F>
+double count(const char* name, const pairs_t& pairs, F&& find) {
+    for(const auto& [from, to] : pairs) {
+        find(from, to);
+    }
+    int found          = 0;
+    const size_t start = allocations;
+    for(const auto& [from, to] : pairs) {
+        found += find(from, to) ? 1 : 0;
+    }
+    const double per_search
+        = static_cast<double>(allocations - start) / pairs.size();
+    std::printf("%-36s %8.2f allocations/search %4d found\n", name, per_search,
+                found);
+    return per_search;
+}
+
+template <typename navigator_t, typename steps_t>
+struct reused_t {
+    AStarSearch<search_node_t<location_t, navigator_t>> search;
+    astar_path_t<location_t, steps_t> path;
+
+    bool operator()(const location_t& from, const location_t& to) {
+        path_find_into<navigator_t>(search, from, to, path, width * height);
+        return path.success;
+    }
+};
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    for(int i = 0; i < width * height; ++i) {
+        walls[i] = rng() % 100 < 30;
+    }
+    pairs_t pairs;
+    for(int i = 0; i < searches; ++i) {
+        const location_t from{static_cast<int>(rng() % width),
+                              static_cast<int>(rng() % height)};
+        const location_t to{static_cast<int>(rng() % width),
+                            static_cast<int>(rng() % height)};
+        walls[from.y * width + from.x] = false;
+        walls[to.y * width + to.x]     = false;
+        pairs.emplace_back(from, to);
+    }
+
+    count("path_find, deque", pairs,
+          [](const location_t& from, const location_t& to) {
+              return path_find<buffered_navigator>(from, to, width * height)
+                  .success;
+          });
+
+    reused_t<vector_navigator, std::deque<location_t>> deque_path;
+    count("path_find_into, vector navigator", pairs, deque_path);
+
+    reused_t<buffered_navigator, std::vector<location_t>> vector_path;
+    const double vector_allocs
+        = count("path_find_into, buffered, vector", pairs, vector_path);
+
+    reused_t<buffered_navigator,
+             compact_path_t<location_t, buffered_navigator>>
+        compact;
+    const double compact_allocs
+        = count("path_find_into, buffered, compact", pairs, compact);
+
+    std::printf("compact path: %zu bytes of codes for %zu steps\n",
+                compact.path.steps.memory_usage(), compact.path.steps.size());
+
+    path_stats_collector_t collector;
+    set_path_stats_collector(&collector);
+    const double stats_allocs
+        = count("path_find_into, compact, stats", pairs, compact);
+    set_path_stats_collector(nullptr);
+    collector.end_frame();
+    const auto frame = collector.last_frame();
+    std::printf("stats: %zu searches, %zu expanded, median %.0f, peak open "
+                "%zu, peak nodes %zu\n",
+                frame.searches, frame.expanded,
+                frame.search_expanded.quantile(0.5), frame.peak_open,
+                frame.peak_nodes);
+
+    if(vector_allocs != 0 || compact_allocs != 0 || stats_allocs != 0) {
+        std::printf("FAIL: steady-state path finding allocated\n");
+        return 1;
+    }
+    return 0;
+}
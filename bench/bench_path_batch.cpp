@@ -0,0 +1,137 @@
+/*
+ * Benchmark of a turn of pathing for 200 agents on a 128x128 map with 30%
+ * random walls: path_find one agent after the other, against
+ * path_find_batch on thread pools of increasing size.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "path_batch.hpp"
+#include "path_finding.hpp"
+#include "thread_pool.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width          = 128;
+constexpr int height         = 128;
+constexpr int agents         = 200;
+constexpr int turns          = 5;
+constexpr size_t limit_steps = width * height;
+
+std::vector<bool> walls(width * height);
+
+struct location_t {
+    int x = -1;
+    int y = -1;
+
+    bool operator==(const location_t& rhs) const {
+        return x == rhs.x && y == rhs.y;
+    }
+};
+
+// Only reads the map, so it can be used from several threads at once
+struct navigator {
+    static float get_distance_estimate(location_t& pos, location_t& goal) {
+        const int dx = std::abs(pos.x - goal.x);
+        const int dy = std::abs(pos.y - goal.y);
+        return static_cast<float>(dx + dy)
+               - 0.58578644f * static_cast<float>(std::min(dx, dy));
+    }
+
+    static bool is_goal(location_t& pos, location_t& goal) {
+        return pos == goal;
+    }
+
+    static bool get_successors(location_t pos,
+                               std::vector<location_t>& successors) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dx = -1; dx <= 1; ++dx) {
+                const location_t next{pos.x + dx, pos.y + dy};
+                if((dx != 0 || dy != 0) && is_walkable(next)) {
+                    successors.push_back(next);
+                }
+            }
+        }
+        return true;
+    }
+
+    static float get_cost(location_t& pos, location_t& successor) {
+        return pos.x != successor.x && pos.y != successor.y ? 1.41421356f
+                                                            : 1.f;
+    }
+
+    static bool is_same_state(location_t& lhs, location_t& rhs) {
+        return lhs == rhs;
+    }
+
+    static int get_hash(location_t& loc) {
+        return loc.y * width + loc.x;
+    }
+
+    static bool is_walkable(const location_t& loc) {
+        return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height
+               && !walls[loc.y * width + loc.x];
+    }
+};
+
+template <typename F>
+void bench(const char* name, F&& turn) {
+    turn();  // warm up the arenas
+    const auto begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < turns; ++i) {
+        turn();
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - begin;
+    std::printf("%-28s %10.2f ms/turn\n", name, elapsed.count() / turns);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    for(int i = 0; i < width * height; ++i) {
+        walls[i] = rng() % 100 < 30;
+    }
+    const location_t player{width / 2, height / 2};
+    walls[player.y * width + player.x] = false;
+    std::vector<std::pair<location_t, location_t>> requests;
+    for(int i = 0; i < agents; ++i) {
+        const location_t agent{static_cast<int>(rng() % width),
+                               static_cast<int>(rng() % height)};
+        walls[agent.y * width + agent.x] = false;
+        requests.emplace_back(agent, player);
+    }
+    std::vector<astar_path_t<location_t>> results(requests.size());
+
+    bench("path_find, one by one", [&] {
+        for(size_t i = 0; i < requests.size(); ++i) {
+            results[i] = path_find<navigator>(
+                requests[i].first, requests[i].second, limit_steps);
+        }
+    });
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    for(size_t threads = 1; threads <= cores; threads *= 2) {
+        thread_pool_t pool(threads);
+        char name[64];
+        std::snprintf(name, sizeof(name), "path_find_batch, %zu threads",
+                      threads);
+        bench(name, [&] {
+            path_find_batch<navigator, location_t>(pool, requests, results,
+                                                   limit_steps);
+        });
+        if(threads < cores && threads * 2 > cores) {
+            threads = cores / 2;  // end on every core
+        }
+    }
+    return 0;
+}
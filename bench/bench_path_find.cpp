@@ -0,0 +1,187 @@
+/*
+ * Benchmark of the path finders on a 256x256 map with 30% random walls:
+ * AStarSearch through search_node_t (linear and hashed lookups) against the
+ * dense grid_search_t, Jump Point Search (online and JPS+) and HPA*. Every
+ * finder solves the same start/goal pairs.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "hierarchical_path_finding.hpp"
+#include "jump_point_search.hpp"
+#include "path_finding.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width    = 256;
+constexpr int height   = 256;
+constexpr int searches = 200;
+
+std::vector<bool> walls(width * height);
+
+struct location_t {
+    int x = -1;
+    int y = -1;
+
+    bool operator==(const location_t& rhs) const {
+        return x == rhs.x && y == rhs.y;
+    }
+};
+
+struct navigator {
+    static float get_distance_estimate(location_t& pos, location_t& goal) {
+        const int dx = std::abs(pos.x - goal.x);
+        const int dy = std::abs(pos.y - goal.y);
+        return static_cast<float>(dx + dy)
+               - 0.58578644f * static_cast<float>(std::min(dx, dy));
+    }
+
+    static bool is_goal(location_t& pos, location_t& goal) {
+        return pos == goal;
+    }
+
+    // a template, so path_find hands it a buffer on the stack
+    template <typename successors_t>
+    static bool get_successors(location_t pos, successors_t& successors) {
+        for(int dy = -1; dy <= 1; ++dy) {
+            for(int dx = -1; dx <= 1; ++dx) {
+                const location_t next{pos.x + dx, pos.y + dy};
+                if((dx != 0 || dy != 0) && is_walkable(next)) {
+                    successors.push_back(next);
+                }
+            }
+        }
+        return true;
+    }
+
+    static float get_cost(location_t& pos, location_t& successor) {
+        return pos.x != successor.x && pos.y != successor.y ? 1.41421356f
+                                                            : 1.f;
+    }
+
+    static bool is_same_state(location_t& lhs, location_t& rhs) {
+        return lhs == rhs;
+    }
+
+    static int get_x(const location_t& loc) {
+        return loc.x;
+    }
+
+    static int get_y(const location_t& loc) {
+        return loc.y;
+    }
+
+    static location_t get_xy(const int x, const int y) {
+        return location_t{x, y};
+    }
+
+    static bool is_walkable(const location_t& loc) {
+        return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height
+               && !walls[loc.y * width + loc.x];
+    }
+};
+
+struct hashed_navigator : navigator {
+    static int get_hash(location_t& loc) {
+        return loc.y * width + loc.x;
+    }
+};
+
+// path_find with an allocator large enough for the whole map, allocated once
+template <typename navigator_t>
+bool astar(const location_t& start, const location_t& end) {
+    using node_t = search_node_t<location_t, navigator_t>;
+    auto a_start = node_t(start);
+    auto a_end   = node_t(end);
+    static AStarSearch<node_t> search(width * height * 8);
+    search.SetStartAndGoalStates(a_start, a_end);
+    unsigned int state = 0;
+    do {
+        state = search.SearchStep();
+    } while(state == AStarSearch<node_t>::kSearchStateSearching);
+    const bool found = state == AStarSearch<node_t>::kSearchStateSucceeded;
+    if(found) {
+        search.FreeSolutionNodes();
+    }
+    return found;
+}
+
+template <typename F>
+void bench(const char* name,
+           const std::vector<std::pair<location_t, location_t>>& pairs,
+           F&& find) {
+    int found        = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for(const auto& [from, to] : pairs) {
+        found += find(from, to) ? 1 : 0;
+    }
+    const std::chrono::duration<double, std::micro> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::printf("%-28s %10.1f us/search %4d found\n", name,
+                elapsed.count() / pairs.size(), found);
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 rng(42);
+    for(int i = 0; i < width * height; ++i) {
+        walls[i] = rng() % 100 < 30;
+    }
+    std::vector<std::pair<location_t, location_t>> pairs;
+    for(int i = 0; i < searches; ++i) {
+        const location_t from{static_cast<int>(rng() % width),
+                              static_cast<int>(rng() % height)};
+        const location_t to{static_cast<int>(rng() % width),
+                            static_cast<int>(rng() % height)};
+        walls[from.y * width + from.x] = false;
+        walls[to.y * width + to.x]     = false;
+        pairs.emplace_back(from, to);
+    }
+
+    bench("AStarSearch, hashed", pairs,
+          [](const location_t& from, const location_t& to) {
+              return astar<hashed_navigator>(from, to);
+          });
+
+    grid_search_t<location_t, navigator> grid(width, height);
+    std::vector<location_t> steps;
+    bench("grid_search_t", pairs,
+          [&](const location_t& from, const location_t& to) {
+              return grid.find(from, to, steps);
+          });
+
+    jps_search_t<location_t, navigator> jps(width, height);
+    bench("jps_search_t", pairs,
+          [&](const location_t& from, const location_t& to) {
+              return jps.find(from, to).success;
+          });
+
+    jps.precompute();
+    bench("jps_search_t, JPS+", pairs,
+          [&](const location_t& from, const location_t& to) {
+              return jps.find(from, to).success;
+          });
+
+    hpa_search_t<location_t, navigator> hpa(width, height);
+    hpa.find(pairs.front().first, pairs.front().second);  // builds the graph
+    bench("hpa_search_t", pairs,
+          [&](const location_t& from, const location_t& to) {
+              return hpa.find(from, to).success;
+          });
+
+    // quadratic, only on the first few pairs
+    pairs.resize(10);
+    bench("AStarSearch, linear (10)", pairs,
+          [](const location_t& from, const location_t& to) {
+              return astar<navigator>(from, to);
+          });
+    return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ * Benchmark of the cell to quad pipeline of virtual_terminal, on the
+ * recording backend: no window or GL context, only the CPU side of render()
+ * is measured.
+ *
+ * Run it from the repository root, so ./resources is found.
+ */
+#include <chrono>
+#include <cstdio>
+
+#include "recording_backend.hpp"
+#include "virtual_terminal.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width  = 200;
+constexpr int height = 100;
+constexpr int frames = 200;
+
+}  // namespace
+
+int main() {
+    SetTraceLogLevel(LOG_WARNING);
+    RegisterFonts("./resources/fonts.json", false);
+    // null backend: stats only, no command recording
+    auto backend = std::make_unique<recording_backend>(false);
+    auto& null   = *backend;
+    set_render_backend(std::move(backend));
+
+    virtual_terminal term("8x8", 0, 0, true);
+    term.resize_chars(width, height);
+
+    for(const int changed_percent : {1, 10, 100}) {
+        const int stride = 100 / changed_percent;
+        null.reset();
+        const auto start = std::chrono::steady_clock::now();
+        for(int frame = 0; frame < frames; ++frame) {
+            {
+                auto out = term.writer();
+                for(int i = frame % stride; i < width * height; i += stride) {
+                    out.set_char(i, vchar_t{(i + frame) % 256, colors::White,
+                                            colors::DarkBlue});
+                }
+            }
+            term.dirty = true;
+            term.render();
+            term.draw();
+        }
+        const std::chrono::duration<double, std::micro> elapsed
+            = std::chrono::steady_clock::now() - start;
+        std::printf("%3d%% cells changed %10.1f us/frame %10.1f quads/frame\n",
+                    changed_percent, elapsed.count() / frames,
+                    static_cast<double>(null.stats().quads) / frames);
+    }
+    return 0;
+}
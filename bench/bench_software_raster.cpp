@@ -0,0 +1,55 @@
+/*
+ * Benchmark of the headless software_rasterizer: a 200x100 terminal with an
+ * 8x8 font drawn into a 1600x800 image, no window or GL context involved.
+ *
+ * Run it from the repository root, so ./resources is found. If a filename is
+ * given, the last frame is saved to it.
+ */
+#include <chrono>
+#include <cstdio>
+
+#include "software_rasterizer.hpp"
+#include "virtual_terminal.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width  = 200;
+constexpr int height = 100;
+constexpr int frames = 100;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    SetTraceLogLevel(LOG_WARNING);
+    RegisterFonts("./resources/fonts.json", false);
+
+    virtual_terminal term("8x8", 0, 0, true);
+    term.resize_chars(width, height);
+    const auto& [fwidth, fheight] = term.get_font_size();
+    software_rasterizer raster(width * fwidth, height * fheight);
+
+    const auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < frames; ++frame) {
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                const auto bg = (x + y) % 2 ? colors::DarkBlue : colors::NONE;
+                term.set_char(
+                    x, y, vchar_t{(x + y + frame) % 256, colors::White, bg});
+            }
+        }
+        raster.clear();
+        raster.draw(term);
+    }
+    const std::chrono::duration<double, std::micro> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::printf("%-28s %10.1f us/frame %8.2f ns/cell\n", "software_rasterizer",
+                elapsed.count() / frames,
+                elapsed.count() * 1000.0 / (frames * width * height));
+
+    if(argc > 1) {
+        raster.export_image(argv[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Microbenchmark: per-cell set_char against the batch write API of
+ * virtual_terminal (writer, write_row, blit), on a 200x100 map terminal.
+ *
+ * Run it from the repository root, so ./resources is found.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "radl.hpp"
+
+using namespace radl;
+
+namespace {
+
+constexpr int width  = 200;
+constexpr int height = 100;
+constexpr int frames = 200;
+
+template <typename F>
+void bench(const char* name, F&& draw_frame) {
+    const auto start = std::chrono::steady_clock::now();
+    for(int frame = 0; frame < frames; ++frame) {
+        draw_frame(frame);
+    }
+    const std::chrono::duration<double, std::micro> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::printf("%-28s %10.1f us/frame %8.2f ns/cell\n", name,
+                elapsed.count() / frames,
+                elapsed.count() * 1000.0 / (frames * width * height));
+}
+
+// Changes every frame, so every write really touches the cell
+vchar_t cell_for(const int frame, const int x, const int y) {
+    return vchar_t{(x + y + frame) % 256, colors::White, colors::NONE};
+}
+
+}  // namespace
+
+int main() {
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    SetTraceLogLevel(LOG_WARNING);
+    InitWindow(64, 64, "bench_vterm_write");
+    RegisterFonts("./resources/fonts.json");
+
+    virtual_terminal term("8x8");
+    term.resize_chars(width, height);
+
+    bench("set_char(x, y)", [&](const int frame) {
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                term.set_char(x, y, cell_for(frame, x, y));
+            }
+        }
+    });
+
+    bench("writer().set_char", [&](const int frame) {
+        auto out = term.writer();
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                out.set_char(x, y, cell_for(frame, x, y));
+            }
+        }
+    });
+
+    std::vector<vchar_t> row(width);
+    bench("write_row", [&](const int frame) {
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                row[x] = cell_for(frame, x, y);
+            }
+            term.write_row(y, row);
+        }
+    });
+
+    std::vector<vchar_t> cells(width * height);
+    bench("blit", [&](const int frame) {
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                cells[y * width + x] = cell_for(frame, x, y);
+            }
+        }
+        term.blit(0, 0, width, height, cells);
+    });
+
+    const int nthreads = static_cast<int>(
+        std::max(1u, std::min(8u, std::thread::hardware_concurrency())));
+    bench("writer() row bands, threads", [&](const int frame) {
+        std::vector<std::jthread> workers;
+        for(int t = 0; t < nthreads; ++t) {
+            workers.emplace_back([&, t] {
+                const int y0 = height * t / nthreads;
+                const int y1 = height * (t + 1) / nthreads;
+                auto out     = term.writer(y0, y1);
+                for(int y = y0; y < y1; ++y) {
+                    for(int x = 0; x < width; ++x) {
+                        out.set_char(x, y, cell_for(frame, x, y));
+                    }
+                }
+            });
+        }
+    });
+
+    term.set_thread_safe(false);
+    bench("set_char, single owner", [&](const int frame) {
+        for(int y = 0; y < height; ++y) {
+            for(int x = 0; x < width; ++x) {
+                term.set_char(x, y, cell_for(frame, x, y));
+            }
+        }
+    });
+
+    CloseWindow();
+    return 0;
+}
@@ -7,8 +7,11 @@
 #include <iostream>
 
 // You need to include the RADL header
+#include "dstar_lite.hpp"
+#include "jump_point_search.hpp"
 #include "path_finding.hpp"
 #include "radl.hpp"
+#include "region_map.hpp"
 
 // We're using a vector to represent the map
 #include <vector>
@@ -187,6 +190,10 @@ struct navigator {
   // might want to behave differently.
   static bool is_same_state(Location &lhs, Location &rhs) { return lhs == rhs; }
 
+  // Optional: a unique number per location lets the A* search find the
+  // locations it already visited in constant time, instead of scanning them.
+  static int get_hash(Location &loc) { return map.at(loc.x, loc.y); }
+
   // We're using the Bresneham's line optimization for pathing this time,
   // which requires a few extra static methods. These are designed to
   // translate between your map format and co-ordinates used by the library
@@ -197,8 +204,32 @@ struct navigator {
   static bool is_walkable(const Location &loc) {
     return map.walkable[map.at(loc.x, loc.y)];
   }
+
+  // Optional: lets path_find give up at once on a goal walled off from the
+  // start, instead of searching everything around it first. Defined below,
+  // with the regions of the map.
+  static bool is_reachable(const Location &from, const Location &to);
 };
 
+// Every step costs the same on this map, which is where Jump Point Search
+// shines: it skips over the many equivalent paths A* would explore. It is
+// used for the previews; the jump distances are precomputed (JPS+) in main,
+// and again whenever a wall is toggled.
+jps_search_t<Location, navigator> jps(MAP_WIDTH, MAP_HEIGHT);
+
+// Once the dude is walking, the path comes from an incremental planner: it
+// keeps its search between calls, so when a wall is toggled under way (right
+// click) only the affected part of the search is redone.
+dstar_lite_t<Location, navigator> planner(MAP_WIDTH, MAP_HEIGHT);
+
+// The connected areas of the map: two tiles in different regions have no
+// path between them, which takes a lookup to find out rather than a search.
+region_map_t<Location, navigator> regions(MAP_WIDTH, MAP_HEIGHT);
+
+bool navigator::is_reachable(const Location &from, const Location &to) {
+  return regions.connected(from, to);
+}
+
 #include "fov.hpp"
 
 // Helper function: calls the RADL visibility permissive-fov algorithm with
@@ -236,6 +267,8 @@ void draw_map() {
   static const auto darkened_wall = apply_colored_light(wall_color, dim_light);
   static const auto not_seen_wall = apply_colored_light(wall_color, dark_light);
 
+  // Lock the terminal once for the whole map, instead of once per tile
+  auto map_writer = map_vterm.writer();
   for (int x = 0; x < map.width; ++x) {
     for (int y = 0; y < map.height; ++y) {
       // Caching so we don't keep doing the calculation
@@ -243,48 +276,48 @@ void draw_map() {
       if (map.walkable[map_idx]) {
         if (map.visible[map_idx]) {
           // Visible tile: render full color
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::BLOCK1,
-                                          lighten_up_floor,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::BLOCK1,
+                                           lighten_up_floor,
+                                           BLANK,
+                                       });
         } else if (map.revealed[map_idx]) {
           // Revealed tile: render grey
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::BLOCK1,
-                                          darkened_floor,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::BLOCK1,
+                                           darkened_floor,
+                                           BLANK,
+                                       });
         } else {
           // We haven't seen it yet - darkest gray
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::BLOCK1,
-                                          not_seen_floor,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::BLOCK1,
+                                           not_seen_floor,
+                                           BLANK,
+                                       });
         }
       } else {
         if (map.visible[map_idx]) {
           // Visible tile: render full color
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::SOLID,
-                                          lighten_up_wall,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::SOLID,
+                                           lighten_up_wall,
+                                           BLANK,
+                                       });
         } else if (map.revealed[map_idx]) {
           // Revealed tile: render grey
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::SOLID,
-                                          darkened_wall,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::SOLID,
+                                           darkened_wall,
+                                           BLANK,
+                                       });
         } else {
           // We haven't seen it yet - darkest gray
-          map_vterm.set_char(map_idx, vchar_t{
-                                          glyphs::SOLID,
-                                          not_seen_wall,
-                                          BLANK,
-                                      });
+          map_writer.set_char(map_idx, vchar_t{
+                                           glyphs::SOLID,
+                                           not_seen_wall,
+                                           BLANK,
+                                       });
         }
       }
     }
@@ -304,6 +337,23 @@ void tick(double duration_secs) {
   static astar_path_t<Location> path;
   auto &dude_vterm = radl::get_vterm(gui_handle_t::G_DUDE);
 
+  // Press I to cycle the map through the diff, instanced and GPU resident
+  // renderers, so you can compare them with the FPS counter.
+  if (IsKeyPressed(KEY_I)) {
+    auto &map_vterm = radl::get_vterm(gui_handle_t::G_MAP);
+    switch (map_vterm.get_render_mode()) {
+    case render_mode_t::diff:
+      map_vterm.set_render_mode(render_mode_t::instanced);
+      break;
+    case render_mode_t::instanced:
+      map_vterm.set_render_mode(render_mode_t::gpu_resident);
+      break;
+    case render_mode_t::gpu_resident:
+      map_vterm.set_render_mode(render_mode_t::diff);
+      break;
+    }
+  }
+
   // Increase the tick time by the frame duration. If it has exceeded
   // the tick duration, then we move the @.
   tick_time += duration_secs;
@@ -314,6 +364,31 @@ void tick(double duration_secs) {
 
     draw_map();
 
+    // Right click opens or closes a "door": toggle the wall under the mouse
+    // and tell the path finders about it.
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+      auto [mouse_x, mouse_y] = get_mouse_position();
+      const int terminal_x = mouse_x / 16;
+      const int terminal_y = mouse_y / 16;
+      const Location door{terminal_x, terminal_y};
+      if (terminal_x > 0 && terminal_y > 0 && terminal_x < map.width - 1 &&
+          terminal_y < map.height - 1 && !(door == dude_position) &&
+          !(door == destination)) {
+        const int idx = map.at(terminal_x, terminal_y);
+        map.walkable[idx] = !map.walkable[idx];
+        planner.update_tile(terminal_x, terminal_y);
+        regions.update_tile(terminal_x, terminal_y);
+        jps.precompute();
+        // Repair the route we are following, rather than starting over
+        if (!(dude_position == destination)) {
+          path = planner.plan(dude_position, destination);
+          if (!path.success) {
+            destination = dude_position;
+          }
+        }
+      }
+    }
+
     // Are we there yet?
     if (dude_position == destination) {
       // Now we poll the mouse to determine where we want to go
@@ -328,26 +403,26 @@ void tick(double duration_secs) {
       const int terminal_y = mouse_y / 16;
       constexpr auto path_finder_limit_calcs = 500;
 
-      // If the mouse is pointing at a walkable location, and the left
-      // button is down - path to the mouse.
-      const bool walkable = map.walkable[map.at(terminal_x, terminal_y)];
-      if (walkable && get_mouse_button_state(MOUSE_BUTTON_LEFT)) {
+      // If the mouse is pointing at a location we can reach, and the left
+      // button is down - path to the mouse. Walls and tiles walled off from
+      // the dude are turned down right away by the region map.
+      const bool reachable =
+          regions.connected(dude_position, Location{terminal_x, terminal_y});
+      if (reachable && get_mouse_button_state(MOUSE_BUTTON_LEFT)) {
         destination.x = terminal_x;
         destination.y = terminal_y;
 
         // Now determine how to get there
-        path = path_find<navigator>(dude_position, destination,
-                                    path_finder_limit_calcs);
+        path = planner.plan(dude_position, destination);
         if (!path.success) {
           destination = dude_position;
           std::cout << "RESET: THIS ISN'T MEANT TO HAPPEN!\n";
         }
-      } else if (walkable) {
+      } else if (reachable) {
         // If the mouse is not clicked, then path to the mouse cursor
         // for display only
-        path = path_find<navigator, Location>(dude_position,
-                                              Location{terminal_x, terminal_y},
-                                              path_finder_limit_calcs);
+        path = jps.find(dude_position, Location{terminal_x, terminal_y},
+                        path_finder_limit_calcs);
       }
     } else if (!path.steps.empty()) {
       // Follow the breadcrumbs!
@@ -411,6 +486,8 @@ int main() {
   radl::gui->add_layer(gui_handle_t::G_DUDE, 0, 0, map.width * 16,
                        map.height * 16, "16x16", nullptr, false,
                        gui_handle_t::G_DUDE);
+  jps.precompute();
+  regions.build();
   // We call the permissive-fov here, so the starting position is
   // revealed
   permissive::squareFov(dude_position.x, dude_position.y, 10, fov);
@@ -0,0 +1,336 @@
+/*
+ * Anytime path finding on grids (ARA*, Likhachev, Gordon & Thrun 2003).
+ *
+ * The first path comes from a strongly weighted A*, found after few
+ * expansions. While there is budget left the weight is lowered step by step
+ * and the path improved, reusing the previous iterations' work, until it is
+ * provably optimal. At any point path() is the best path so far and
+ * suboptimality() a bound on how much longer than the shortest it can be.
+ *
+ * Typical use is one improve(budget) per frame until done(), walking the
+ * current path meanwhile.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "path_finding.hpp"
+#include "search_deadline.hpp"
+
+namespace radl {
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class ara_search_t {
+private:
+    static constexpr bool diagonal  = grid_diagonal_moves<navigator_t>();
+    static constexpr int directions = diagonal ? 8 : 4;
+    static constexpr float no_path  = std::numeric_limits<float>::infinity();
+
+    struct entry_t {
+        float key;
+        // cost from the start when pushed, the entry is stale if it changed
+        float g;
+        int cell;
+
+        bool operator>(const entry_t& rhs) const noexcept {
+            return key > rhs.key;
+        }
+    };
+
+    int m_width  = 0;
+    int m_height = 0;
+    std::vector<float> m_g;
+    std::vector<int> m_parent;
+    // generation of the search that last reached each cell
+    std::vector<uint32_t> m_visited;
+    // iteration that expanded each cell, and that queued it as inconsistent
+    std::vector<uint32_t> m_closed;
+    std::vector<uint32_t> m_inconsistent;
+    uint32_t m_generation = 0;
+    uint32_t m_iteration  = 0;
+    std::vector<entry_t> m_open;
+    // improved after their expansion in this iteration, reopened in the next
+    std::vector<int> m_incons;
+
+    int m_start         = -1;
+    int m_goal          = -1;
+    float m_weight      = 1.f;
+    float m_weight_step = 0.f;
+    float m_bound       = no_path;
+    bool m_done         = true;
+    size_t m_expanded   = 0;
+    astar_path_t<location_t> m_path;
+
+    inline float heuristic(const int cell) const noexcept {
+        return grid_distance<diagonal>(cell % m_width - m_goal % m_width,
+                                       cell / m_width - m_goal / m_width);
+    }
+
+    inline float goal_cost() const noexcept {
+        return m_visited[m_goal] == m_generation ? m_g[m_goal] : no_path;
+    }
+
+    inline bool stale(const entry_t& entry) const noexcept {
+        return m_closed[entry.cell] == m_iteration
+               || entry.g != m_g[entry.cell];
+    }
+
+    void push(const int cell) {
+        m_open.push_back(
+            {m_g[cell] + m_weight * heuristic(cell), m_g[cell], cell});
+        std::push_heap(m_open.begin(), m_open.end(), std::greater<>());
+    }
+
+    void expand(const int cell) {
+        const int x   = cell % m_width;
+        const int y   = cell / m_width;
+        const float g = m_g[cell];
+        for(int d = 0; d < directions; ++d) {
+            const int nx = x + grid_dx[d];
+            const int ny = y + grid_dy[d];
+            if(nx < 0 || ny < 0 || nx >= m_width || ny >= m_height) {
+                continue;
+            }
+            const location_t loc = navigator_t::get_xy(nx, ny);
+            if(!navigator_t::is_walkable(loc)) {
+                continue;
+            }
+            float cost = grid_step_cost(d);
+            if constexpr(weighted_grid_navigator<navigator_t, location_t>) {
+                cost *= static_cast<float>(navigator_t::get_tile_cost(loc));
+            }
+            const int next     = ny * m_width + nx;
+            const float next_g = g + cost;
+            if(m_visited[next] == m_generation && m_g[next] <= next_g) {
+                continue;
+            }
+            m_visited[next] = m_generation;
+            m_g[next]       = next_g;
+            m_parent[next]  = cell;
+            if(m_closed[next] != m_iteration) {
+                push(next);
+            } else if(m_inconsistent[next] != m_iteration) {
+                m_inconsistent[next] = m_iteration;
+                m_incons.push_back(next);
+            }
+        }
+    }
+
+    // Runs the current iteration, returns true once it is complete
+    bool improve_path(search_deadline_t& deadline, size_t& expansions) {
+        while(!m_open.empty()) {
+            const entry_t top = m_open.front();
+            if(stale(top)) {
+                std::pop_heap(m_open.begin(), m_open.end(), std::greater<>());
+                m_open.pop_back();
+                continue;
+            }
+            if(goal_cost() <= top.key) {
+                return true;
+            }
+            if(expansions == 0 || deadline.expired()) {
+                return false;
+            }
+            --expansions;
+            std::pop_heap(m_open.begin(), m_open.end(), std::greater<>());
+            m_open.pop_back();
+            m_closed[top.cell] = m_iteration;
+            ++m_expanded;
+            expand(top.cell);
+        }
+        return true;
+    }
+
+    // Publishes the iteration's path and bound, then sets up the next one
+    void finish_iteration() {
+        const float cost = goal_cost();
+        if(cost == no_path) {
+            // the unweighted search fails the same way
+            m_done = true;
+            return;
+        }
+        m_path.success = true;
+        m_path.steps.clear();
+        for(int cell = m_goal; cell != -1; cell = m_parent[cell]) {
+            m_path.steps.push_front(
+                navigator_t::get_xy(cell % m_width, cell / m_width));
+        }
+
+        // the shortest path is at least the lowest unweighted f left
+        float lowest = no_path;
+        for(const entry_t& entry : m_open) {
+            if(!stale(entry)) {
+                lowest = std::min(lowest, entry.g + heuristic(entry.cell));
+            }
+        }
+        for(const int cell : m_incons) {
+            lowest = std::min(lowest, m_g[cell] + heuristic(cell));
+        }
+        m_bound = lowest >= cost ? 1.f : std::min(m_weight, cost / lowest);
+        if(m_weight <= 1.f || m_bound <= 1.f) {
+            m_bound = 1.f;
+            m_done  = true;
+            return;
+        }
+
+        // next iteration: lower weight, the inconsistent cells reopened and
+        // everything open keyed again
+        m_weight = std::max(1.f, m_weight - m_weight_step);
+        std::erase_if(m_open,
+                      [this](const entry_t& entry) { return stale(entry); });
+        for(const int cell : m_incons) {
+            m_open.push_back({0.f, m_g[cell], cell});
+        }
+        m_incons.clear();
+        for(entry_t& entry : m_open) {
+            entry.key = entry.g + m_weight * heuristic(entry.cell);
+        }
+        std::make_heap(m_open.begin(), m_open.end(), std::greater<>());
+        next_iteration();
+    }
+
+    void next_iteration() {
+        if(++m_iteration == 0) {
+            std::fill(m_closed.begin(), m_closed.end(), 0);
+            std::fill(m_inconsistent.begin(), m_inconsistent.end(), 0);
+            m_iteration = 1;
+        }
+    }
+
+    bool run(search_deadline_t deadline, size_t expansions) {
+        while(!m_done) {
+            if(!improve_path(deadline, expansions)) {
+                break;
+            }
+            finish_iteration();
+        }
+        return !m_done;
+    }
+
+public:
+    ara_search_t(const int width, const int height) {
+        resize(width, height);
+    }
+
+    /**
+     * @brief Sets the size of the map, must be done when the map size changes.
+     */
+    void resize(const int width, const int height) {
+        m_width        = width;
+        m_height       = height;
+        const size_t n = static_cast<size_t>(width) * height;
+        m_g.assign(n, 0.f);
+        m_parent.assign(n, -1);
+        m_visited.assign(n, 0);
+        m_closed.assign(n, 0);
+        m_inconsistent.assign(n, 0);
+        m_generation = 0;
+        m_iteration  = 0;
+        m_done       = true;
+    }
+
+    /**
+     * @brief Starts a search from @p start to @p end, nothing is expanded
+     * until improve().
+     *
+     * @param initial_weight heuristic weight of the first iteration
+     * @param weight_step how much the weight drops at each iteration
+     */
+    void start(const location_t& start, const location_t& end,
+               const float initial_weight = 3.f,
+               const float weight_step    = 0.5f) {
+        m_path        = astar_path_t<location_t>{false, end};
+        m_bound       = no_path;
+        m_expanded    = 0;
+        m_weight      = std::max(1.f, initial_weight);
+        m_weight_step = std::max(weight_step, 0.01f);
+        m_open.clear();
+        m_incons.clear();
+        const int sx = navigator_t::get_x(start);
+        const int sy = navigator_t::get_y(start);
+        const int gx = navigator_t::get_x(end);
+        const int gy = navigator_t::get_y(end);
+        if(sx < 0 || sy < 0 || sx >= m_width || sy >= m_height || gx < 0
+           || gy < 0 || gx >= m_width || gy >= m_height) {
+            m_done = true;
+            return;
+        }
+        if(++m_generation == 0) {
+            std::fill(m_visited.begin(), m_visited.end(), 0);
+            m_generation = 1;
+        }
+        next_iteration();
+        m_start            = sy * m_width + sx;
+        m_goal             = gy * m_width + gx;
+        m_done             = false;
+        m_g[m_start]       = 0.f;
+        m_parent[m_start]  = -1;
+        m_visited[m_start] = m_generation;
+        push(m_start);
+    }
+
+    /**
+     * @brief Searches for up to @p budget, improving the path.
+     * @return true while the path can still be improved
+     */
+    bool improve(const std::chrono::microseconds budget) {
+        return run(search_deadline_t(budget),
+                   std::numeric_limits<size_t>::max());
+    }
+
+    /**
+     * @brief Expands at most @p expansions cells, improving the path.
+     * @return true while the path can still be improved
+     */
+    bool improve_expansions(const size_t expansions) {
+        return run(search_deadline_t(), expansions);
+    }
+
+    /**
+     * @brief Nothing left to improve: the path is optimal, or there is none.
+     */
+    inline bool done() const noexcept {
+        return m_done;
+    }
+
+    /**
+     * @brief The best path found so far, start and end included.
+     */
+    inline const astar_path_t<location_t>& path() const noexcept {
+        return m_path;
+    }
+
+    /**
+     * @brief The current path costs at most this many times the shortest
+     * one (infinity until a path is found).
+     */
+    inline float suboptimality() const noexcept {
+        return m_bound;
+    }
+
+    /**
+     * @brief Heuristic weight of the iteration under way.
+     */
+    inline float weight() const noexcept {
+        return m_weight;
+    }
+
+    /**
+     * @brief Cells expanded since start().
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+};
+
+}  // namespace radl
@@ -29,14 +29,16 @@ given where due.
 // stl includes
 #include <algorithm>
 #include <cfloat>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <vector>
 
-// fast fixed size memory allocator, used for fast node memory management
-#include "fsa.hpp"
-
-// Fixed size memory allocator can be disabled to compare performance
-// Uses std new and delete instead if you turn it off
-#define USE_FSA_MEMORY 1
+// growable node storage, reused from one search to the next
+#include "node_arena.hpp"
 
 // disable warning that debugging information has lines that are truncated
 // occurs in stl headers
@@ -46,6 +48,14 @@ given where due.
 
 template <class T> class AStarState;
 
+// Optional hook: a user state with a Hash() member gets O(1) open/closed list
+// lookups instead of linear scans. States that are IsSameState must hash
+// equally.
+template <class UserState>
+concept AStarHashableState = requires(UserState &state) {
+  { state.Hash() } -> std::convertible_to<std::size_t>;
+};
+
 // The AStar search class. UserState is the users state space type
 template <class UserState> class AStarSearch {
 public: // data
@@ -72,6 +82,9 @@ public: // data
     float f = 0.F; // sum of cumulative cost of predecessors and self and
                    // heuristic
 
+    int heap_index = -1;   // position in the open list, -1 when not open
+    int closed_index = -1; // position in the closed list, -1 when not closed
+
     Node() = default;
 
     UserState m_UserState;
@@ -85,31 +98,97 @@ public: // data
     bool operator()(const Node *x, const Node *y) const { return x->f > y->f; }
   };
 
+  static constexpr bool kHashedStates = AStarHashableState<UserState>;
+
+  // Nodes with nothing to destroy are dropped all at once by resetting the
+  // arena, instead of one by one
+  static constexpr bool kTrivialNodes = std::is_trivially_destructible_v<Node>;
+
+  // Share one (e.g. thread_local) between searches that run one after the
+  // other, so the nodes are only allocated once
+  using NodeArena = radl::node_arena_t<Node>;
+
+  // Counters of the current (or last) search, reset by SetStartAndGoalStates
+  struct SearchStats {
+    int expanded = 0;   // nodes popped and expanded
+    int pushes = 0;     // open list pushes, reopened nodes included
+    int pops = 0;       // open list pops
+    int rejected = 0;   // successors dropped for a cheaper known node
+    int peak_open = 0;  // largest open list
+    int peak_nodes = 0; // most nodes allocated at once
+  };
+
+  // States the search expanded and opened, in order, for visualisation. An
+  // opened state that was not expanded was still open when the search ended.
+  struct SearchTrace {
+    std::vector<UserState> expanded;
+    std::vector<UserState> opened;
+
+    void clear() {
+      expanded.clear();
+      opened.clear();
+    }
+  };
+
 public: // methods
   // constructor just initialises private data
   AStarSearch()
       : state_(kSearchStateNotInitialised), current_solution_node_(nullptr),
-#if USE_FSA_MEMORY
-        m_FixedSizeAllocator(1000)
+        own_arena_(std::make_unique<NodeArena>()), arena_(own_arena_.get()) {}
 
-#endif
-  {
+  // MaxNodes: how many nodes to make room for up front, the arena still
+  // grows past it
+  explicit AStarSearch(int MaxNodes)
+      : state_(kSearchStateNotInitialised), current_solution_node_(nullptr),
+        own_arena_(std::make_unique<NodeArena>(MaxNodes)),
+        arena_(own_arena_.get()) {
+    // Sized for the node pool up front, so a search never pauses to grow
+    // them (which matters when it is stepped within a frame budget)
+    open_list_.reserve(MaxNodes);
+    closed_list_.reserve(MaxNodes);
+    if constexpr (kHashedStates) {
+      KnownReserve(static_cast<std::size_t>(MaxNodes));
+    }
   }
 
-  explicit AStarSearch(int MaxNodes)
+  // Searches with nodes from @p Arena, which must outlive the search and not
+  // be used by another search at the same time
+  explicit AStarSearch(NodeArena &Arena)
       : state_(kSearchStateNotInitialised), current_solution_node_(nullptr),
-#if USE_FSA_MEMORY
-        m_FixedSizeAllocator(MaxNodes)
+        arena_(&Arena) {}
 
-#endif
-  {
-  }
+  const NodeArena &GetNodeArena() const { return *arena_; }
 
   // call at any time to cancel the search and free up all the memory
   void CancelSearch() { m_CancelRequest = true; }
 
+  // Weighted A*: the heuristic counts Weight (>= 1) times, so the search
+  // heads for the goal more greedily and expands far fewer nodes. With an
+  // admissible heuristic the path costs at most Weight times the optimal
+  // one. Takes effect at the next SetStartAndGoalStates.
+  void SetHeuristicWeight(float Weight) { heuristic_weight_ = Weight; }
+
+  float GetHeuristicWeight() const { return heuristic_weight_; }
+
+  const SearchStats &GetStats() const { return stats_; }
+
+  // Records the following searches into @p Trace (nullptr stops), which is
+  // cleared at each SetStartAndGoalStates. Costs a copy of every state
+  // opened, leave it off outside of debugging.
+  void SetTrace(SearchTrace *Trace) { trace_ = Trace; }
+
   // Set Start and goal states
   void SetStartAndGoalStates(UserState &Start, UserState &Goal) {
+    if constexpr (kTrivialNodes) {
+      // whatever a previous search left behind is dropped here
+      ResetNodes();
+    }
+    m_CancelRequest = false;
+    steps_ = 0;
+    stats_ = SearchStats{};
+    if (trace_) {
+      trace_->clear();
+    }
     start_ = AllocateNode();
     goal_ = AllocateNode();
 
@@ -125,15 +204,17 @@ public: // methods
 
     start_->g = 0;
     start_->h = start_->m_UserState.GoalDistanceEstimate(goal_->m_UserState);
-    start_->f = start_->g + start_->h;
+    start_->f = start_->g + heuristic_weight_ * start_->h;
     start_->parent = 0;
 
     // Push the start node on the Open list
-
-    open_list_.push_back(start_); // heap now unsorted
-
-    // Sort back element into heap
-    push_heap(open_list_.begin(), open_list_.end(), HeapCompare());
+    OpenPush(start_);
+    if (trace_) {
+      trace_->opened.push_back(start_->m_UserState);
+    }
+    if constexpr (kHashedStates) {
+      KnownInsert(start_);
+    }
 
     // Initialise counter for search steps
     steps_ = 0;
@@ -163,9 +244,10 @@ public: // methods
     steps_++;
 
     // Pop the best node (the one with the lowest f)
-    Node *n = open_list_.front(); // get pointer to the node
-    pop_heap(open_list_.begin(), open_list_.end(), HeapCompare());
-    open_list_.pop_back();
+    Node *n = OpenPop();
+    if (trace_) {
+      trace_->expanded.push_back(n->m_UserState);
+    }
 
     // Check for the goal, once we pop that we're done
     if (n->m_UserState.IsGoal(goal_->m_UserState)) {
@@ -202,6 +284,8 @@ public: // methods
       return state_;
     }
     // not goal
+    ++stats_.expanded;
+
     // We now need to generate the successors of this node
     // The user helps us to do this, and we keep the new nodes in
     // m_Successors ...
@@ -241,49 +325,14 @@ public: // methods
       // Now we need to find whether the node is on the open or closed
       // lists If it is but the node that is already on them is better
       // (lower g) then we can forget about this successor
+      Node *known = FindKnownNode(*successor);
 
-      // First linear search of open list to find node
-
-      typename std::vector<Node *>::iterator openlist_result;
-
-      for (openlist_result = open_list_.begin();
-           openlist_result != open_list_.end(); openlist_result++) {
-        if ((*openlist_result)
-                ->m_UserState.IsSameState((*successor)->m_UserState)) {
-          break;
-        }
-      }
-
-      if (openlist_result != open_list_.end()) {
-        // we found this state on open
-
-        if ((*openlist_result)->g <= newg) {
-          FreeNode((*successor));
-
-          // the one on Open is cheaper than this one
-          continue;
-        }
-      }
-
-      typename std::vector<Node *>::iterator closedlist_result;
-
-      for (closedlist_result = closed_list_.begin();
-           closedlist_result != closed_list_.end(); closedlist_result++) {
-        if ((*closedlist_result)
-                ->m_UserState.IsSameState((*successor)->m_UserState)) {
-          break;
-        }
-      }
-
-      if (closedlist_result != closed_list_.end()) {
-        // we found this state on closed
-
-        if ((*closedlist_result)->g <= newg) {
-          // the one on Closed is cheaper than this one
-          FreeNode((*successor));
+      if (known && known->g <= newg) {
+        // the one on Open or Closed is cheaper than this one
+        FreeNode((*successor));
+        ++stats_.rejected;
 
-          continue;
-        }
+        continue;
       }
 
       // This node is the best node so far with this particular state
@@ -293,60 +342,30 @@ public: // methods
       (*successor)->g = newg;
       (*successor)->h =
           (*successor)->m_UserState.GoalDistanceEstimate(goal_->m_UserState);
-      (*successor)->f = (*successor)->g + (*successor)->h;
-
-      // Successor in closed list
-      // 1 - Update old version of this node in closed list
-      // 2 - Move it from closed to open list
-      // 3 - Sort heap again in open list
+      (*successor)->f =
+          (*successor)->g + heuristic_weight_ * (*successor)->h;
 
-      if (closedlist_result != closed_list_.end()) {
-        // Update closed node with successor node AStar data
-        //*(*closedlist_result) = *(*successor);
-        (*closedlist_result)->parent = (*successor)->parent;
-        (*closedlist_result)->g = (*successor)->g;
-        (*closedlist_result)->h = (*successor)->h;
-        (*closedlist_result)->f = (*successor)->f;
+      if (known) {
+        // Update the known node with the successor node AStar data
+        known->parent = (*successor)->parent;
+        known->g = (*successor)->g;
+        known->h = (*successor)->h;
+        known->f = (*successor)->f;
 
         // Free successor node
         FreeNode((*successor));
 
-        // Push closed node into open list
-        open_list_.push_back((*closedlist_result));
-
-        // Remove closed node from closed list
-        closed_list_.erase(closedlist_result);
-
-        // Sort back element into heap
-        push_heap(open_list_.begin(), open_list_.end(), HeapCompare());
-
-        // Fix thanks to ...
-        // Greg Douglas <gregdouglasmail@gmail.com>
-        // who noticed that this code path was incorrect
-        // Here we have found a new state which is already CLOSED
-      }
-
-      // Successor in open list
-      // 1 - Update old version of this node in open list
-      // 2 - sort heap again in open list
-
-      else if (openlist_result != open_list_.end()) {
-        // Update open node with successor node AStar data
-        //*(*openlist_result) = *(*successor);
-        (*openlist_result)->parent = (*successor)->parent;
-        (*openlist_result)->g = (*successor)->g;
-        (*openlist_result)->h = (*successor)->h;
-        (*openlist_result)->f = (*successor)->f;
-
-        // Free successor node
-        FreeNode((*successor));
-
-        // re-make the heap
-        // make_heap rather than sort_heap is an essential bug fix
-        // thanks to Mike Ryynanen for pointing this out and then
-        // explaining it in detail. sort_heap called on an invalid
-        // heap does not work
-        make_heap(open_list_.begin(), open_list_.end(), HeapCompare());
+        if (known->heap_index >= 0) {
+          // Successor in open list: its f only decreased, sift it up
+          OpenDecreased(known);
+        } else {
+          // Successor in closed list: move it back to the open list
+          // Fix thanks to ...
+          // Greg Douglas <gregdouglasmail@gmail.com>
+          // who noticed that this code path was incorrect
+          ClosedRemove(known);
+          OpenPush(known);
+        }
       }
 
       // New successor
@@ -354,17 +373,21 @@ public: // methods
       // 2 - sort heap again in open list
 
       else {
-        // Push successor node into open list
-        open_list_.push_back((*successor));
-
-        // Sort back element into heap
-        push_heap(open_list_.begin(), open_list_.end(), HeapCompare());
+        OpenPush(*successor);
+        if (trace_) {
+          trace_->opened.push_back((*successor)->m_UserState);
+        }
+        if constexpr (kHashedStates) {
+          KnownInsert(*successor);
+        }
       }
     }
 
-    // push n onto Closed, as we have expanded it now
-
-    closed_list_.push_back(n);
+    // push n onto Closed, as we have expanded it now (unless one of its own
+    // successors reopened it)
+    if (n->heap_index < 0) {
+      ClosedPush(n);
+    }
 
     return state_; // Succeeded bool is false at this point.
   }
@@ -389,6 +412,10 @@ public: // methods
   // This is done to clean up all used Node memory when you are done with the
   // search
   void FreeSolutionNodes() {
+    if constexpr (kTrivialNodes) {
+      ResetNodes();
+      return;
+    }
     Node *n = start_;
 
     if (start_->child) {
@@ -547,16 +574,199 @@ public: // methods
 
   int GetStepCount() { return steps_; }
 
-  void EnsureMemoryFreed() {
-#if USE_FSA_MEMORY
-    assert(m_AllocateNodeCount == 0);
-#endif
-  }
+  void EnsureMemoryFreed() { assert(m_AllocateNodeCount == 0); }
 
 private: // methods
+  // Open list: binary min-heap on f, every node knows its position so a
+  // decrease-key is a single sift up instead of a full make_heap
+
+  void HeapSet(std::size_t index, Node *node) {
+    open_list_[index] = node;
+    node->heap_index = static_cast<int>(index);
+  }
+
+  void HeapSiftUp(std::size_t index) {
+    Node *node = open_list_[index];
+    while (index > 0) {
+      const std::size_t parent = (index - 1) / 2;
+      if (!HeapCompare()(open_list_[parent], node)) {
+        break;
+      }
+      HeapSet(index, open_list_[parent]);
+      index = parent;
+    }
+    HeapSet(index, node);
+  }
+
+  void HeapSiftDown(std::size_t index) {
+    Node *node = open_list_[index];
+    const std::size_t size = open_list_.size();
+    for (;;) {
+      std::size_t child = index * 2 + 1;
+      if (child >= size) {
+        break;
+      }
+      if (child + 1 < size &&
+          HeapCompare()(open_list_[child], open_list_[child + 1])) {
+        ++child;
+      }
+      if (!HeapCompare()(node, open_list_[child])) {
+        break;
+      }
+      HeapSet(index, open_list_[child]);
+      index = child;
+    }
+    HeapSet(index, node);
+  }
+
+  void OpenPush(Node *node) {
+    open_list_.push_back(node);
+    HeapSiftUp(open_list_.size() - 1);
+    ++stats_.pushes;
+    stats_.peak_open =
+        std::max(stats_.peak_open, static_cast<int>(open_list_.size()));
+  }
+
+  Node *OpenPop() {
+    Node *best = open_list_.front();
+    Node *last = open_list_.back();
+    open_list_.pop_back();
+    if (!open_list_.empty()) {
+      HeapSet(0, last);
+      HeapSiftDown(0);
+    }
+    best->heap_index = -1;
+    ++stats_.pops;
+    return best;
+  }
+
+  void OpenDecreased(Node *node) {
+    HeapSiftUp(static_cast<std::size_t>(node->heap_index));
+  }
+
+  // Closed list: unordered, removal swaps with the last node
+
+  void ClosedPush(Node *node) {
+    node->closed_index = static_cast<int>(closed_list_.size());
+    closed_list_.push_back(node);
+  }
+
+  void ClosedRemove(Node *node) {
+    if (node->closed_index < 0) {
+      return;
+    }
+    Node *last = closed_list_.back();
+    closed_list_[node->closed_index] = last;
+    last->closed_index = node->closed_index;
+    closed_list_.pop_back();
+    node->closed_index = -1;
+  }
+
+  // The open or closed node with the same state as @p node, nullptr if
+  // there is none
+  Node *FindKnownNode(Node *node) {
+    if constexpr (kHashedStates) {
+      return KnownFind(node);
+    } else {
+      for (Node *open : open_list_) {
+        if (open->m_UserState.IsSameState(node->m_UserState)) {
+          return open;
+        }
+      }
+      for (Node *closed : closed_list_) {
+        if (closed->m_UserState.IsSameState(node->m_UserState)) {
+          return closed;
+        }
+      }
+      return nullptr;
+    }
+  }
+
+  // Known nodes: open addressing with linear probing over a power of two
+  // table. Nodes are only ever added during a search and all dropped at its
+  // end, so there are no tombstones, and clearing only touches the filled
+  // slots: a reused search stops allocating once the table has grown.
+
+  std::size_t KnownSlot(Node *node) const {
+    // Fibonacci hashing, spreads the sequential hashes of grid tiles
+    const auto hash = static_cast<std::uint64_t>(node->m_UserState.Hash());
+    return static_cast<std::size_t>((hash * 0x9E3779B97F4A7C15ULL) >>
+                                    known_shift_);
+  }
+
+  void KnownReserve(std::size_t Count) {
+    std::size_t slots = 16;
+    int shift = 60;
+    while (slots < Count * 2) {
+      slots *= 2;
+      --shift;
+    }
+    if (slots <= known_slots_.size()) {
+      return;
+    }
+    std::vector<Node *> old;
+    old.swap(known_slots_);
+    known_slots_.assign(slots, nullptr);
+    known_shift_ = shift;
+    known_filled_.clear();
+    known_filled_.reserve(slots / 2);
+    for (Node *node : old) {
+      if (node) {
+        KnownInsert(node);
+      }
+    }
+  }
+
+  void KnownInsert(Node *node) {
+    if ((known_filled_.size() + 1) * 2 > known_slots_.size()) {
+      KnownReserve(known_filled_.size() + 1);
+    }
+    const std::size_t mask = known_slots_.size() - 1;
+    std::size_t slot = KnownSlot(node);
+    while (known_slots_[slot]) {
+      slot = (slot + 1) & mask;
+    }
+    known_slots_[slot] = node;
+    known_filled_.push_back(slot);
+  }
+
+  Node *KnownFind(Node *node) const {
+    if (known_slots_.empty()) {
+      return nullptr;
+    }
+    const std::size_t mask = known_slots_.size() - 1;
+    for (std::size_t slot = KnownSlot(node); known_slots_[slot];
+         slot = (slot + 1) & mask) {
+      if (known_slots_[slot]->m_UserState.IsSameState(node->m_UserState)) {
+        return known_slots_[slot];
+      }
+    }
+    return nullptr;
+  }
+
+  void KnownClear() {
+    for (std::size_t slot : known_filled_) {
+      known_slots_[slot] = nullptr;
+    }
+    known_filled_.clear();
+  }
+
+  // Drops every node at once, they must have nothing to destroy
+  void ResetNodes() {
+    arena_->reset();
+    m_AllocateNodeCount = 0;
+  }
+
   // This is called when a search fails or is cancelled to free all used
   // memory
   void FreeAllNodes() {
+    if constexpr (kTrivialNodes) {
+      open_list_.clear();
+      closed_list_.clear();
+      KnownClear();
+      ResetNodes();
+      return;
+    }
     // iterate open list and delete all nodes
     auto iter_open = open_list_.begin();
     while (iter_open != open_list_.end()) {
@@ -576,6 +786,7 @@ private: // methods
     }
 
     closed_list_.clear();
+    KnownClear();
 
     // delete the goal
 
@@ -586,6 +797,13 @@ private: // methods
   // nodes may be created that are still present when the search ends. They
   // will be deleted by this routine once the search ends
   void FreeUnusedNodes() {
+    if constexpr (kTrivialNodes) {
+      // left in the arena until the solution nodes are freed
+      open_list_.clear();
+      closed_list_.clear();
+      KnownClear();
+      return;
+    }
     // iterate open list and delete unused nodes
     typename std::vector<Node *>::iterator iterOpen = open_list_.begin();
 
@@ -615,35 +833,21 @@ private: // methods
     }
 
     closed_list_.clear();
+    KnownClear();
   }
 
   // Node memory management
   Node *AllocateNode() {
-#if !USE_FSA_MEMORY
-    m_AllocateNodeCount++;
-    Node *p = new Node;
-    return p;
-#else
-    Node *address = m_FixedSizeAllocator.alloc();
-
-    if (!address) {
-      return nullptr;
-    }
+    Node *p = new (arena_->allocate()) Node;
     m_AllocateNodeCount++;
-    Node *p = new (address) Node;
+    stats_.peak_nodes = std::max(stats_.peak_nodes, m_AllocateNodeCount);
     return p;
-#endif
   }
 
   void FreeNode(Node *node) {
     m_AllocateNodeCount--;
-
-#if !USE_FSA_MEMORY
-    delete node;
-#else
     node->~Node();
-    m_FixedSizeAllocator.free(node);
-#endif
+    arena_->free(node);
   }
 
   // Heap (simple vector but used as a heap, cf. Steve Rabin's game gems
@@ -653,6 +857,12 @@ private: // methods
   // Closed list is a vector.
   std::vector<Node *> closed_list_;
 
+  // Every open and closed node, by state (AStarHashableState only), and the
+  // slots filled in the current search
+  std::vector<Node *> known_slots_;
+  std::vector<std::size_t> known_filled_;
+  int known_shift_ = 60;
+
   // Successors is a vector filled out by the user each type successors to a
   // node are generated
   std::vector<Node *> successors_;
@@ -669,10 +879,9 @@ private: // methods
 
   Node *current_solution_node_;
 
-#if USE_FSA_MEMORY
-  // Memory
-  FixedSizeAllocator<Node> m_FixedSizeAllocator;
-#endif
+  // Node memory, our own unless an arena was passed in
+  std::unique_ptr<NodeArena> own_arena_;
+  NodeArena *arena_;
 
   // Debug : need to keep these two iterators around
   // for the user Dbg functions
@@ -683,6 +892,11 @@ private: // methods
   int m_AllocateNodeCount = 0;
 
   bool m_CancelRequest = false;
+
+  float heuristic_weight_ = 1.F;
+
+  SearchStats stats_;
+  SearchTrace *trace_ = nullptr;
 };
 
 template <class T> class AStarState {
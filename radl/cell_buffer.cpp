@@ -0,0 +1,183 @@
+#include "cell_buffer.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define RADL_CELLS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace radl {
+
+namespace {
+
+#if defined(__AVX2__)
+using lanes_t            = __m256i;
+constexpr int lane_count = 8;
+
+inline lanes_t load(const void* src) {
+    return _mm256_loadu_si256(static_cast<const lanes_t*>(src));
+}
+
+inline void store(void* dst, const lanes_t value) {
+    _mm256_storeu_si256(static_cast<lanes_t*>(dst), value);
+}
+
+inline lanes_t broadcast(const uint32_t value) {
+    return _mm256_set1_epi32(static_cast<int>(value));
+}
+
+inline lanes_t equal(const lanes_t a, const lanes_t b) {
+    return _mm256_cmpeq_epi32(a, b);
+}
+
+inline lanes_t both(const lanes_t a, const lanes_t b) {
+    return _mm256_and_si256(a, b);
+}
+
+inline uint32_t lane_mask(const lanes_t value) {
+    return static_cast<uint32_t>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(value)));
+}
+#elif defined(RADL_CELLS_SSE2)
+using lanes_t            = __m128i;
+constexpr int lane_count = 4;
+
+inline lanes_t load(const void* src) {
+    return _mm_loadu_si128(static_cast<const lanes_t*>(src));
+}
+
+inline void store(void* dst, const lanes_t value) {
+    _mm_storeu_si128(static_cast<lanes_t*>(dst), value);
+}
+
+inline lanes_t broadcast(const uint32_t value) {
+    return _mm_set1_epi32(static_cast<int>(value));
+}
+
+inline lanes_t equal(const lanes_t a, const lanes_t b) {
+    return _mm_cmpeq_epi32(a, b);
+}
+
+inline lanes_t both(const lanes_t a, const lanes_t b) {
+    return _mm_and_si128(a, b);
+}
+
+inline uint32_t lane_mask(const lanes_t value) {
+    return static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(value)));
+}
+#endif
+
+#if defined(__AVX2__) || defined(RADL_CELLS_SSE2)
+constexpr uint32_t all_lanes = (uint32_t{1} << lane_count) - 1;
+
+template <typename T>
+void fill_plane(T* data, const size_t size, const T& value) {
+    const lanes_t lanes = broadcast(std::bit_cast<uint32_t>(value));
+    size_t i            = 0;
+    for(; i + lane_count <= size; i += lane_count) {
+        store(data + i, lanes);
+    }
+    for(; i < size; ++i) {
+        data[i] = value;
+    }
+}
+#else
+template <typename T>
+void fill_plane(T* data, const size_t size, const T& value) {
+    std::fill(data, data + size, value);
+}
+#endif
+
+}  // namespace
+
+uint32_t cell_buffer_t::diff(const cell_buffer_t& other, const size_t first,
+                             const int count) const {
+    uint32_t changed = 0;
+#if defined(__AVX2__) || defined(RADL_CELLS_SSE2)
+    if(count == chunk_size) {
+        for(int i = 0; i < chunk_size; i += lane_count) {
+            const size_t index = first + i;
+            lanes_t same
+                = equal(load(&m_glyphs[index]), load(&other.m_glyphs[index]));
+            if(!m_palette) {
+                same = both(same, equal(load(&m_foregrounds[index]),
+                                        load(&other.m_foregrounds[index])));
+                same = both(same, equal(load(&m_backgrounds[index]),
+                                        load(&other.m_backgrounds[index])));
+            }
+            changed |= (~lane_mask(same) & all_lanes) << i;
+        }
+        return changed;
+    }
+#endif
+    for(int i = 0; i < count; ++i) {
+        const size_t index = first + i;
+        bool differs       = m_glyphs[index] != other.m_glyphs[index];
+        if(!m_palette) {
+            differs = differs
+                      || !(m_foregrounds[index] == other.m_foregrounds[index])
+                      || !(m_backgrounds[index] == other.m_backgrounds[index]);
+        }
+        if(differs) {
+            changed |= uint32_t{1} << i;
+        }
+    }
+    return changed;
+}
+
+uint32_t cell_buffer_t::assign(const size_t first, const int count,
+                               const vchar_t& vch) {
+    uint32_t changed = 0;
+#if defined(__AVX2__) || defined(RADL_CELLS_SSE2)
+    if(count == chunk_size && m_palette) {
+        const lanes_t packed = broadcast(encode(vch));
+        for(int i = 0; i < chunk_size; i += lane_count) {
+            const size_t index = first + i;
+            const lanes_t same = equal(load(&m_glyphs[index]), packed);
+            changed |= (~lane_mask(same) & all_lanes) << i;
+            store(&m_glyphs[index], packed);
+        }
+        return changed;
+    }
+    if(count == chunk_size) {
+        const lanes_t glyph = broadcast(vch.glyph);
+        const lanes_t fg = broadcast(std::bit_cast<uint32_t>(vch.foreground));
+        const lanes_t bg = broadcast(std::bit_cast<uint32_t>(vch.background));
+        for(int i = 0; i < chunk_size; i += lane_count) {
+            const size_t index = first + i;
+            const lanes_t same
+                = both(both(equal(load(&m_glyphs[index]), glyph),
+                            equal(load(&m_foregrounds[index]), fg)),
+                       equal(load(&m_backgrounds[index]), bg));
+            changed |= (~lane_mask(same) & all_lanes) << i;
+            store(&m_glyphs[index], glyph);
+            store(&m_foregrounds[index], fg);
+            store(&m_backgrounds[index], bg);
+        }
+        return changed;
+    }
+#endif
+    const uint32_t packed = m_palette ? encode(vch) : 0;
+    for(int i = 0; i < count; ++i) {
+        if(m_palette ? assign_packed(first + i, packed)
+                     : assign(first + i, vch)) {
+            changed |= uint32_t{1} << i;
+        }
+    }
+    return changed;
+}
+
+void cell_buffer_t::fill(const vchar_t& vch) {
+    if(m_palette) {
+        fill_plane(m_glyphs.data(), m_glyphs.size(), encode(vch));
+        return;
+    }
+    fill_plane(m_glyphs.data(), m_glyphs.size(), vch.glyph);
+    fill_plane(m_foregrounds.data(), m_foregrounds.size(), vch.foreground);
+    fill_plane(m_backgrounds.data(), m_backgrounds.size(), vch.background);
+}
+
+}  // namespace radl
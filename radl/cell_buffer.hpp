@@ -0,0 +1,222 @@
+/*
+ * Structure of arrays storage for the cells of a virtual terminal: glyphs,
+ * foreground and background colors live in three separate planes of 32-bit
+ * values, so change detection and fills can run as SIMD compares/stores over
+ * 32 cells at a time (AVX2 or SSE2, with a scalar fallback).
+ *
+ * With a palette set, the cells are palette_cell_t packed in the glyph plane
+ * and the color planes are unused: a third of the memory and of the diffing
+ * work.
+ */
+
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "palette.hpp"
+#include "vchar.hpp"
+
+namespace radl {
+
+static_assert(sizeof(color_t) == sizeof(uint32_t),
+              "color_t must be packed in 32 bits");
+
+class cell_buffer_t {
+private:
+    std::vector<uint32_t> m_glyphs;
+    std::vector<color_t> m_foregrounds;
+    std::vector<color_t> m_backgrounds;
+    const palette_t* m_palette = nullptr;
+
+    inline uint32_t encode(const vchar_t& vch) const {
+        return m_palette->encode(vch.glyph, vch.foreground, vch.background)
+            .pack();
+    }
+
+    inline bool assign_packed(const size_t index, const uint32_t packed) {
+        if(m_glyphs[index] == packed) {
+            return false;
+        }
+        m_glyphs[index] = packed;
+        return true;
+    }
+
+public:
+    // Number of cells handled by a single diff/assign call
+    static constexpr int chunk_size = 32;
+
+    inline void resize(const size_t size) {
+        m_glyphs.resize(size);
+        if(!m_palette) {
+            m_foregrounds.resize(size);
+            m_backgrounds.resize(size);
+        }
+    }
+
+    /**
+     * @brief Switches to palette cells resolved through @p palette (or back to
+     * full color cells when nullptr). Every cell is reset to zero.
+     */
+    inline void set_palette(const palette_t* palette) {
+        const size_t cells = size();
+        m_palette          = palette;
+        m_glyphs.assign(cells, 0);
+        m_foregrounds.clear();
+        m_backgrounds.clear();
+        m_foregrounds.shrink_to_fit();
+        m_backgrounds.shrink_to_fit();
+        resize(cells);
+    }
+
+    /**
+     * @brief Resolves the same palette cells through @p palette, e.g. a copy
+     * of the palette. Unlike set_palette the cells are kept, both palettes
+     * must be set.
+     */
+    inline void bind_palette(const palette_t* palette) noexcept {
+        assert(m_palette && palette);
+        m_palette = palette;
+    }
+
+    inline const palette_t* palette() const noexcept {
+        return m_palette;
+    }
+
+    inline size_t size() const noexcept {
+        return m_glyphs.size();
+    }
+
+    inline vchar_t get(const size_t index) const {
+        if(m_palette) {
+            const auto cell = palette_cell_t::unpack(m_glyphs[index]);
+            return vchar_t{uint32_t{cell.glyph}, (*m_palette)[cell.foreground],
+                           (*m_palette)[cell.background]};
+        }
+        return vchar_t{m_glyphs[index], m_foregrounds[index],
+                       m_backgrounds[index]};
+    }
+
+    /**
+     * @brief The cell at @p index as it was written: like get(), with the
+     * source colors of the palette entries (see palette_t::source).
+     */
+    inline vchar_t get_written(const size_t index) const {
+        if(m_palette) {
+            const auto cell = palette_cell_t::unpack(m_glyphs[index]);
+            return vchar_t{uint32_t{cell.glyph},
+                           m_palette->source(cell.foreground),
+                           m_palette->source(cell.background)};
+        }
+        return get(index);
+    }
+
+    /**
+     * @brief Stores @p vch at @p index. With a palette, its colors must be in
+     * the palette.
+     */
+    inline void set(const size_t index, const vchar_t& vch) {
+        if(m_palette) {
+            m_glyphs[index] = encode(vch);
+            return;
+        }
+        m_glyphs[index]      = vch.glyph;
+        m_foregrounds[index] = vch.foreground;
+        m_backgrounds[index] = vch.background;
+    }
+
+    /**
+     * @brief Copies the cell at @p index of @p other, both buffers must use
+     * the same palette (or none).
+     */
+    inline void copy(const size_t index, const cell_buffer_t& other) noexcept {
+        m_glyphs[index] = other.m_glyphs[index];
+        if(!m_palette) {
+            m_foregrounds[index] = other.m_foregrounds[index];
+            m_backgrounds[index] = other.m_backgrounds[index];
+        }
+    }
+
+    /**
+     * @brief Makes every cell differ from the same cell of @p other, so the
+     * next diff against it reports them all.
+     */
+    inline void mismatch(const cell_buffer_t& other) noexcept {
+        for(size_t i = 0; i < m_glyphs.size(); ++i) {
+            m_glyphs[i] = ~other.m_glyphs[i];
+        }
+    }
+
+    inline bool equals(const size_t index, const vchar_t& vch) const {
+        if(m_palette) {
+            return m_glyphs[index] == encode(vch);
+        }
+        return m_glyphs[index] == vch.glyph
+               && m_foregrounds[index] == vch.foreground
+               && m_backgrounds[index] == vch.background;
+    }
+
+    /**
+     * @brief Stores @p vch at @p index, returns true if the cell changed.
+     */
+    inline bool assign(const size_t index, const vchar_t& vch) {
+        if(m_palette) {
+            return assign_packed(index, encode(vch));
+        }
+        if(equals(index, vch)) {
+            return false;
+        }
+        set(index, vch);
+        return true;
+    }
+
+    /**
+     * @brief Stores the palette cell @p cell at @p index, returns true if the
+     * cell changed. Only valid with a palette set.
+     */
+    inline bool assign(const size_t index, const palette_cell_t& cell) {
+        assert(m_palette);
+        return assign_packed(index, cell.pack());
+    }
+
+    /**
+     * @brief The glyph plane, packed palette cells when a palette is set.
+     */
+    inline const uint32_t* glyphs() const noexcept {
+        return m_glyphs.data();
+    }
+
+    inline const color_t* foregrounds() const noexcept {
+        return m_foregrounds.data();
+    }
+
+    inline const color_t* backgrounds() const noexcept {
+        return m_backgrounds.data();
+    }
+
+    /**
+     * @brief Compares the cells [first, first + count) with @p other.
+     *
+     * @param count at most chunk_size
+     * @return bit i is set if cell first + i differs
+     */
+    uint32_t diff(const cell_buffer_t& other, size_t first, int count) const;
+
+    /**
+     * @brief Stores @p vch in the cells [first, first + count).
+     *
+     * @param count at most chunk_size
+     * @return bit i is set if cell first + i changed
+     */
+    uint32_t assign(size_t first, int count, const vchar_t& vch);
+
+    /**
+     * @brief Stores @p vch in every cell.
+     */
+    void fill(const vchar_t& vch);
+};
+
+}  // namespace radl
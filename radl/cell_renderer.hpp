@@ -0,0 +1,32 @@
+/*
+ * Interface for the alternative (whole terminal) render paths of a
+ * virtual_terminal, see render_mode_t.
+ */
+
+#pragma once
+
+#include "cell_buffer.hpp"
+#include "font_manager.hpp"
+#include "texture.hpp"
+
+namespace radl {
+
+class cell_renderer {
+public:
+    virtual ~cell_renderer() = default;
+
+    /**
+     * @brief (Re)creates the GPU resources to hold @p columns x @p rows cells.
+     */
+    virtual void resize(int columns, int rows) = 0;
+
+    /**
+     * @brief Redraws every cell of @p cells into @p target.
+     *
+     * @param has_background if false, cell backgrounds are not drawn
+     */
+    virtual void render(RenderTexture2D& target, const bitmap_font& font,
+                        const cell_buffer_t& cells, bool has_background) = 0;
+};
+
+}  // namespace radl
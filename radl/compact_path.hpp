@@ -0,0 +1,191 @@
+/*
+ * Path steps stored as 3-bit direction codes: the front location is kept
+ * whole and every following step is one of the 8 neighbours of the one
+ * before it, 21 steps to a 64-bit word. A drop-in for the steps deque of
+ * astar_path_t (push_back, front, pop_front, size, iteration) on grid maps,
+ * e.g. astar_path_t<location_t, compact_path_t<location_t, navigator>>.
+ *
+ * clear() keeps the words, so a path reused by path_find_into stops
+ * allocating once it has held its longest path.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+namespace radl {
+
+/*
+ * The navigator needs the grid accessors of grid_navigator:
+ *   static int get_x(const location_t&);
+ *   static int get_y(const location_t&);
+ *   static location_t get_xy(int x, int y);
+ */
+template <typename location_t, typename navigator_t>
+class compact_path_t {
+private:
+    static constexpr int code_bits      = 3;
+    static constexpr int codes_per_word = 64 / code_bits;
+
+    // offsets of the codes 0..7, the 3x3 block around a tile without its
+    // center
+    static constexpr int dx[8] = {-1, 0, 1, -1, 1, -1, 0, 1};
+    static constexpr int dy[8] = {-1, -1, -1, 0, 0, 1, 1, 1};
+
+    std::vector<uint64_t> m_words;
+    location_t m_front{};
+    location_t m_back{};
+    // index of the code leading away from m_front
+    size_t m_head = 0;
+    // locations stored, the front one included
+    size_t m_size = 0;
+
+    static inline uint64_t encode(const int step_x, const int step_y) {
+        assert(step_x >= -1 && step_x <= 1 && step_y >= -1 && step_y <= 1
+               && (step_x != 0 || step_y != 0)
+               && "compact_path_t steps must be to a neighbouring tile");
+        const int index = (step_y + 1) * 3 + (step_x + 1);
+        return static_cast<uint64_t>(index < 4 ? index : index - 1);
+    }
+
+    inline int code(const size_t index) const noexcept {
+        const uint64_t word = m_words[index / codes_per_word];
+        return static_cast<int>(
+            (word >> ((index % codes_per_word) * code_bits)) & 7u);
+    }
+
+    static inline location_t advance(const location_t& loc, const int code) {
+        return navigator_t::get_xy(navigator_t::get_x(loc) + dx[code],
+                                   navigator_t::get_y(loc) + dy[code]);
+    }
+
+public:
+    using value_type = location_t;
+
+    class const_iterator {
+    private:
+        const compact_path_t* m_path = nullptr;
+        size_t m_index               = 0;
+        location_t m_loc{};
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type        = location_t;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = const location_t*;
+        using reference         = const location_t&;
+
+        const_iterator() = default;
+
+        const_iterator(const compact_path_t* path, const size_t index,
+                       const location_t& loc)
+            : m_path(path)
+            , m_index(index)
+            , m_loc(loc) {
+        }
+
+        inline const location_t& operator*() const noexcept {
+            return m_loc;
+        }
+
+        inline const location_t* operator->() const noexcept {
+            return &m_loc;
+        }
+
+        const_iterator& operator++() {
+            // the last location has no code leading away from it
+            if(m_index + 1 < m_path->m_head + m_path->m_size) {
+                m_loc = advance(m_loc, m_path->code(m_index));
+            }
+            ++m_index;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        inline bool operator==(const const_iterator& rhs) const noexcept {
+            return m_index == rhs.m_index;
+        }
+    };
+
+    inline size_t size() const noexcept {
+        return m_size;
+    }
+
+    inline bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    // Bytes taken by the direction codes
+    inline size_t memory_usage() const noexcept {
+        return m_words.capacity() * sizeof(uint64_t);
+    }
+
+    inline const location_t& front() const noexcept {
+        assert(m_size > 0);
+        return m_front;
+    }
+
+    inline const location_t& back() const noexcept {
+        assert(m_size > 0);
+        return m_back;
+    }
+
+    void push_back(const location_t& loc) {
+        if(m_size == 0) {
+            m_front = loc;
+            m_back  = loc;
+            m_size  = 1;
+            return;
+        }
+        const size_t index = m_head + m_size - 1;
+        const size_t word  = index / codes_per_word;
+        if(word == m_words.size()) {
+            m_words.push_back(0);
+        }
+        const int shift = static_cast<int>(index % codes_per_word) * code_bits;
+        m_words[word]   = (m_words[word] & ~(uint64_t{7} << shift))
+                        | encode(navigator_t::get_x(loc)
+                                     - navigator_t::get_x(m_back),
+                                 navigator_t::get_y(loc)
+                                     - navigator_t::get_y(m_back))
+                              << shift;
+        m_back = loc;
+        ++m_size;
+    }
+
+    void pop_front() {
+        assert(m_size > 0);
+        if(--m_size == 0) {
+            clear();
+            return;
+        }
+        m_front = advance(m_front, code(m_head));
+        ++m_head;
+    }
+
+    // Keeps the words for the next path
+    inline void clear() noexcept {
+        m_words.clear();
+        m_head = 0;
+        m_size = 0;
+    }
+
+    inline const_iterator begin() const {
+        return const_iterator(this, m_head, m_front);
+    }
+
+    inline const_iterator end() const {
+        return const_iterator(this, m_head + m_size, m_back);
+    }
+};
+
+}  // namespace radl
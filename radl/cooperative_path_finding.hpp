@@ -0,0 +1,519 @@
+/*
+ * Cooperative path finding for crowds (windowed hierarchical cooperative A*,
+ * Silver 2005, with a plain distance heuristic instead of the hierarchical
+ * one). Agents are planned one after the other in priority order through
+ * space and time: each plan covers the next `window` turns and is written to
+ * a reservation table of (x, y, t), which the agents planned after it steer
+ * around, waiting in place when they must. Two agents never end a turn on
+ * the same tile or swap tiles during one.
+ *
+ * Plans are redone every window / 2 turns, staggered so only a slice of the
+ * agents replans on any turn, and each search expands a bounded number of
+ * nodes: with replan_limit on top, the cost of a turn stays bounded however
+ * many agents there are.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "radix_heap.hpp"
+
+namespace radl {
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class cooperative_planner_t {
+private:
+    static constexpr bool diagonal  = grid_diagonal_moves<navigator_t>();
+    static constexpr int directions = diagonal ? 8 : 4;
+
+    struct agent_t {
+        int cell     = -1;
+        int goal     = -1;
+        int priority = 0;
+        // cells the agent stands on from turn plan_time on
+        std::vector<int> plan;
+        size_t plan_time = 0;
+        // turn of the next replan
+        size_t replan_at = 0;
+    };
+
+    // who stands on a tile at a turn, valid when time matches
+    struct reservation_t {
+        int agent     = -1;
+        uint32_t time = 0;
+    };
+
+    struct node_t {
+        int cell    = -1;
+        int dt      = 0;
+        int parent  = -1;
+        float g     = 0.f;
+        bool closed = false;
+    };
+
+    int m_width   = 0;
+    int m_height  = 0;
+    int m_window  = 0;
+    size_t m_time = 0;
+    size_t m_replan_limit    = std::numeric_limits<size_t>::max();
+    size_t m_expansion_limit = 4096;
+    std::vector<agent_t> m_agents;
+    // agents in planning order, and the ones due for a replan this turn
+    std::vector<int> m_order;
+    std::vector<int> m_due;
+    // ring of window + 1 turns of reservations, cells * turns
+    std::vector<reservation_t> m_reservations;
+
+    // space-time search, nodes found by (cell, dt) through a stamped open
+    // addressing table
+    std::vector<node_t> m_nodes;
+    std::vector<int> m_slots;
+    std::vector<uint32_t> m_slot_stamps;
+    uint32_t m_generation = 0;
+    radix_heap_t<int> m_open;
+    size_t m_expanded  = 0;
+    size_t m_replanned = 0;
+
+    inline reservation_t& reservation(const int cell, const size_t time) {
+        const size_t turn = time % static_cast<size_t>(m_window + 1);
+        return m_reservations[turn * m_width * m_height + cell];
+    }
+
+    // Agent standing on @p cell at @p time, -1 for none
+    inline int reserved_by(const int cell, const size_t time) {
+        const reservation_t& entry = reservation(cell, time);
+        return entry.time == static_cast<uint32_t>(time) ? entry.agent : -1;
+    }
+
+    inline bool free_for(const int cell, const size_t time, const int agent) {
+        const int other = reserved_by(cell, time);
+        return other == -1 || other == agent;
+    }
+
+    void reserve(const int agent) {
+        const agent_t& a = m_agents[agent];
+        for(size_t i = 0; i < a.plan.size(); ++i) {
+            const size_t time = a.plan_time + i;
+            if(time >= m_time && reserved_by(a.plan[i], time) == -1) {
+                reservation(a.plan[i], time)
+                    = reservation_t{agent, static_cast<uint32_t>(time)};
+            }
+        }
+    }
+
+    void release(const int agent) {
+        const agent_t& a = m_agents[agent];
+        for(size_t i = 0; i < a.plan.size(); ++i) {
+            const size_t time = a.plan_time + i;
+            if(time >= m_time && reserved_by(a.plan[i], time) == agent) {
+                reservation(a.plan[i], time) = reservation_t{};
+            }
+        }
+    }
+
+    inline float heuristic(const int cell, const int goal) const noexcept {
+        return grid_distance<diagonal>(cell % m_width - goal % m_width,
+                                       cell / m_width - goal / m_width);
+    }
+
+    void next_generation() {
+        if(++m_generation == 0) {
+            std::fill(m_slot_stamps.begin(), m_slot_stamps.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    // First slot to probe for (cell, dt)
+    inline size_t slot_of(const int cell, const int dt) const noexcept {
+        const uint64_t key = static_cast<uint64_t>(cell)
+                                 * static_cast<uint64_t>(m_window + 1)
+                             + static_cast<uint64_t>(dt);
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32)
+               & (m_slots.size() - 1);
+    }
+
+    // Node of (cell, dt), created when missing; @p created tells which
+    int node_at(const int cell, const int dt, bool& created) {
+        if((m_nodes.size() + 1) * 2 > m_slots.size()) {
+            grow_slots();
+        }
+        const size_t mask = m_slots.size() - 1;
+        size_t slot       = slot_of(cell, dt);
+        while(m_slot_stamps[slot] == m_generation) {
+            const node_t& node = m_nodes[m_slots[slot]];
+            if(node.cell == cell && node.dt == dt) {
+                created = false;
+                return m_slots[slot];
+            }
+            slot = (slot + 1) & mask;
+        }
+        m_slot_stamps[slot] = m_generation;
+        m_slots[slot]       = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(node_t{cell, dt});
+        created = true;
+        return m_slots[slot];
+    }
+
+    void grow_slots() {
+        const size_t size = std::max<size_t>(m_slots.size() * 2, 1024);
+        m_slots.assign(size, -1);
+        m_slot_stamps.assign(size, 0);
+        m_generation = 1;
+        const size_t mask = size - 1;
+        for(size_t i = 0; i < m_nodes.size(); ++i) {
+            size_t slot = slot_of(m_nodes[i].cell, m_nodes[i].dt);
+            while(m_slot_stamps[slot] == m_generation) {
+                slot = (slot + 1) & mask;
+            }
+            m_slot_stamps[slot] = m_generation;
+            m_slots[slot]       = static_cast<int>(i);
+        }
+    }
+
+    // True if the agent can stay on its goal from @p time to the end of the
+    // window
+    bool can_rest(const int agent, const int goal, const size_t time) {
+        for(size_t t = time + 1; t <= m_time + m_window; ++t) {
+            if(!free_for(goal, t, agent)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Space-time A* from the agent's cell over the next m_window turns
+    void plan(const int agent) {
+        agent_t& a = m_agents[agent];
+        release(agent);
+        a.plan.clear();
+        a.plan_time = m_time;
+
+        next_generation();
+        m_nodes.clear();
+        m_open.clear();
+        bool created    = false;
+        const int first = node_at(a.cell, 0, created);
+        m_open.push(radix_heap_t<int>::float_key(heuristic(a.cell, a.goal)),
+                    first);
+        int best        = -1;
+        // the furthest the search got in time, to follow when it gives up
+        int deepest     = first;
+        size_t expanded = 0;
+        while(!m_open.empty()) {
+            const int index = m_open.pop().second;
+            if(m_nodes[index].closed) {
+                continue;
+            }
+            m_nodes[index].closed = true;
+            const node_t node     = m_nodes[index];
+            const size_t time     = m_time + node.dt;
+            if(node.dt > m_nodes[deepest].dt) {
+                deepest = index;
+            }
+            if(node.dt == m_window
+               || (node.cell == a.goal && can_rest(agent, a.goal, time))) {
+                best = index;
+                break;
+            }
+            if(++expanded > m_expansion_limit) {
+                break;
+            }
+            const int x = node.cell % m_width;
+            const int y = node.cell / m_width;
+            // the grid moves, then waiting in place
+            for(int d = 0; d <= directions; ++d) {
+                const bool wait = d == directions;
+                const int nx    = wait ? x : x + grid_dx[d];
+                const int ny    = wait ? y : y + grid_dy[d];
+                if(nx < 0 || ny < 0 || nx >= m_width || ny >= m_height) {
+                    continue;
+                }
+                const int next = ny * m_width + nx;
+                if(!free_for(next, time + 1, agent)) {
+                    continue;
+                }
+                // no swapping tiles with the agent coming the other way
+                const int coming = reserved_by(next, time);
+                if(!wait && coming != -1 && coming != agent
+                   && reserved_by(node.cell, time + 1) == coming) {
+                    continue;
+                }
+                float cost = 1.f;
+                if(!wait) {
+                    const location_t loc = navigator_t::get_xy(nx, ny);
+                    if(!navigator_t::is_walkable(loc)) {
+                        continue;
+                    }
+                    cost = grid_step_cost(d);
+                    if constexpr(weighted_grid_navigator<navigator_t,
+                                                         location_t>) {
+                        cost *= static_cast<float>(
+                            navigator_t::get_tile_cost(loc));
+                    }
+                } else if(node.cell == a.goal) {
+                    cost = 0.f;
+                }
+                const int child = node_at(next, node.dt + 1, created);
+                const float g   = m_nodes[index].g + cost;
+                if(!created
+                   && (m_nodes[child].closed || m_nodes[child].g <= g)) {
+                    continue;
+                }
+                m_nodes[child].g      = g;
+                m_nodes[child].parent = index;
+                // float rounding must not break the monotone heap
+                const uint32_t key = std::max(
+                    radix_heap_t<int>::float_key(g + heuristic(next, a.goal)),
+                    m_open.last_key());
+                m_open.push(key, child);
+            }
+        }
+        m_expanded += expanded;
+
+        // out of expansions: as far as the search got without a collision
+        for(int index = best >= 0 ? best : deepest; index != -1;
+            index     = m_nodes[index].parent) {
+            a.plan.push_back(m_nodes[index].cell);
+        }
+        std::reverse(a.plan.begin(), a.plan.end());
+        // rest at the end of the plan until the window is over
+        while(a.plan.size() <= static_cast<size_t>(m_window)
+              && free_for(a.plan.back(), m_time + a.plan.size(), agent)) {
+            a.plan.push_back(a.plan.back());
+        }
+        reserve(agent);
+        // staggered by id, every half window, or earlier when the plan runs
+        // out
+        const auto interval = static_cast<size_t>(std::max(1, m_window / 2));
+        a.replan_at = m_time + interval - (m_time + agent) % interval;
+        a.replan_at = std::min(a.replan_at, m_time + a.plan.size() - 1);
+        ++m_replanned;
+    }
+
+    // True if the agent has no tile planned for the next turn
+    inline bool ran_out(const agent_t& a) const noexcept {
+        return m_time + 1 >= a.plan_time + a.plan.size();
+    }
+
+    inline bool plans_before(const int a, const int b) const noexcept {
+        return m_agents[a].priority < m_agents[b].priority
+               || (m_agents[a].priority == m_agents[b].priority && a < b);
+    }
+
+    inline int cell_of(const location_t& loc) const {
+        return navigator_t::get_y(loc) * m_width + navigator_t::get_x(loc);
+    }
+
+    inline location_t location_of(const int cell) const {
+        return navigator_t::get_xy(cell % m_width, cell / m_width);
+    }
+
+public:
+    /**
+     * @param window turns planned ahead by each agent; longer windows see
+     * further around crowds at a higher cost per search
+     */
+    cooperative_planner_t(const int width, const int height,
+                          const int window = 16)
+        : m_width(width)
+        , m_height(height)
+        , m_window(window) {
+        if(window < 1) {
+            throw std::runtime_error("cooperative_planner_t: window < 1");
+        }
+        m_reservations.resize(static_cast<size_t>(width) * height
+                              * (window + 1));
+    }
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    inline int window() const noexcept {
+        return m_window;
+    }
+
+    /**
+     * @brief Turns simulated so far.
+     */
+    inline size_t time() const noexcept {
+        return m_time;
+    }
+
+    /**
+     * @brief Most agents replanned in one update(). The others wait for the
+     * next turn, holding to the rest of their plan; only agents with no plan
+     * left for the next turn go over the limit.
+     */
+    inline void set_replan_limit(const size_t agents) noexcept {
+        m_replan_limit = std::max<size_t>(agents, 1);
+    }
+
+    /**
+     * @brief Most nodes expanded by the search of one agent, which then
+     * holds its tile until its next turn.
+     */
+    inline void set_expansion_limit(const size_t nodes) noexcept {
+        m_expansion_limit = nodes;
+    }
+
+    /**
+     * @brief Adds an agent, planned at the next update(). Agents of lower
+     * priority are planned first and so get their way; ties go to the
+     * earliest added.
+     * @return the id of the agent
+     */
+    int add_agent(const location_t& position, const location_t& goal,
+                  const int priority = 0) {
+        const int id = static_cast<int>(m_agents.size());
+        agent_t agent;
+        agent.cell      = cell_of(position);
+        agent.goal      = cell_of(goal);
+        agent.priority  = priority;
+        // holds its tile until planned, the agents planned first go around
+        agent.plan.assign(m_window + 1, agent.cell);
+        agent.plan_time = m_time;
+        agent.replan_at = m_time;
+        m_agents.push_back(std::move(agent));
+        reserve(id);
+        const auto at = std::upper_bound(
+            m_order.begin(), m_order.end(), id,
+            [this](const int a, const int b) { return plans_before(a, b); });
+        m_order.insert(at, id);
+        return id;
+    }
+
+    inline size_t agent_count() const noexcept {
+        return m_agents.size();
+    }
+
+    /**
+     * @brief Sends an agent somewhere else, replanned at the next update().
+     */
+    void set_goal(const int agent, const location_t& goal) {
+        m_agents[agent].goal      = cell_of(goal);
+        m_agents[agent].replan_at = m_time;
+    }
+
+    inline location_t position(const int agent) const {
+        return location_of(m_agents[agent].cell);
+    }
+
+    inline location_t goal(const int agent) const {
+        return location_of(m_agents[agent].goal);
+    }
+
+    inline bool arrived(const int agent) const noexcept {
+        return m_agents[agent].cell == m_agents[agent].goal;
+    }
+
+    /**
+     * @brief The tiles the agent means to stand on over the coming turns,
+     * its current one first.
+     */
+    void planned_steps(const int agent, std::vector<location_t>& steps) const {
+        steps.clear();
+        const agent_t& a = m_agents[agent];
+        for(size_t i = m_time - a.plan_time; i < a.plan.size(); ++i) {
+            steps.push_back(location_of(a.plan[i]));
+        }
+    }
+
+    /**
+     * @brief Agent that will stand on x/y @p turns from now (up to the
+     * window), -1 for none.
+     */
+    int reserved_by(const int x, const int y, const int turns = 0) {
+        return reserved_by(y * m_width + x, m_time + turns);
+    }
+
+    /**
+     * @brief Plays one turn: replans the agents whose turn it is (at most
+     * replan_limit, the plans running out soonest first, in priority order),
+     * then moves every agent one step along its plan.
+     */
+    void update() {
+        m_expanded  = 0;
+        m_replanned = 0;
+        m_due.clear();
+        for(const int agent : m_order) {
+            if(m_agents[agent].replan_at <= m_time) {
+                m_due.push_back(agent);
+            }
+        }
+        if(m_due.size() > m_replan_limit) {
+            // the plans running out soonest first, then the longest waiting
+            std::stable_sort(m_due.begin(), m_due.end(),
+                             [this](const int a, const int b) {
+                                 const agent_t& first  = m_agents[a];
+                                 const agent_t& second = m_agents[b];
+                                 const size_t end_a
+                                     = first.plan_time + first.plan.size();
+                                 const size_t end_b
+                                     = second.plan_time + second.plan.size();
+                                 if(end_a != end_b) {
+                                     return end_a < end_b;
+                                 }
+                                 return first.replan_at < second.replan_at;
+                             });
+            // the ones without a next step cannot wait
+            const auto out = std::count_if(
+                m_due.begin(), m_due.end(),
+                [this](const int agent) { return ran_out(m_agents[agent]); });
+            m_due.resize(std::max(m_replan_limit, static_cast<size_t>(out)));
+            std::sort(m_due.begin(), m_due.end(),
+                      [this](const int a, const int b) {
+                          return plans_before(a, b);
+                      });
+        }
+        for(const int agent : m_due) {
+            plan(agent);
+        }
+        // the ones left waiting hold their tile for another turn
+        for(int agent = 0; agent < static_cast<int>(m_agents.size());
+            ++agent) {
+            agent_t& a = m_agents[agent];
+            if(ran_out(a)) {
+                a.plan.push_back(a.plan.back());
+                const size_t time = m_time + 1;
+                if(reserved_by(a.plan.back(), time) == -1) {
+                    reservation(a.plan.back(), time)
+                        = reservation_t{agent, static_cast<uint32_t>(time)};
+                }
+            }
+        }
+        ++m_time;
+        for(agent_t& a : m_agents) {
+            a.cell = a.plan[m_time - a.plan_time];
+        }
+    }
+
+    /**
+     * @brief Nodes expanded by the searches of the last update().
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief Agents replanned by the last update().
+     */
+    inline size_t replanned() const noexcept {
+        return m_replanned;
+    }
+};
+
+}  // namespace radl
@@ -0,0 +1,203 @@
+#include "dijkstra_map.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RADL_DIJKSTRA_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace radl {
+
+namespace {
+
+/*
+ * Relaxes @p row from the adjacent row @p other (straight and diagonal moves)
+ * over @p count cells. The rows have a padding cell on each side. Returns
+ * true if a distance changed.
+ */
+bool relax_from_row(float* row, const float* other, const float* costs,
+                    const int count, const float max_distance) {
+    int x        = 0;
+    bool changed = false;
+#if defined(RADL_DIJKSTRA_SSE2)
+    const __m128 diagonal = _mm_set1_ps(grid_sqrt2);
+    const __m128 cutoff   = _mm_set1_ps(max_distance);
+    __m128 lowered        = _mm_setzero_ps();
+    for(; x + 4 <= count; x += 4) {
+        const __m128 cost   = _mm_loadu_ps(costs + x);
+        const __m128 before = _mm_loadu_ps(row + x);
+        const __m128 side   = _mm_min_ps(_mm_loadu_ps(other + x - 1),
+                                         _mm_loadu_ps(other + x + 1));
+        __m128 candidate
+            = _mm_min_ps(_mm_add_ps(_mm_loadu_ps(other + x), cost),
+                         _mm_add_ps(side, _mm_mul_ps(cost, diagonal)));
+        // past the cutoff counts as no path
+        const __m128 in_reach = _mm_cmple_ps(candidate, cutoff);
+        candidate = _mm_or_ps(_mm_and_ps(in_reach, candidate),
+                              _mm_andnot_ps(in_reach, before));
+        lowered   = _mm_or_ps(lowered, _mm_cmplt_ps(candidate, before));
+        _mm_storeu_ps(row + x, _mm_min_ps(before, candidate));
+    }
+    changed = _mm_movemask_ps(lowered) != 0;
+#endif
+    for(; x < count; ++x) {
+        const float cost      = costs[x];
+        const float candidate = std::min(
+            other[x] + cost,
+            std::min(other[x - 1], other[x + 1]) + cost * grid_sqrt2);
+        if(candidate < row[x] && candidate <= max_distance) {
+            row[x]  = candidate;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/*
+ * Relaxes @p row along itself, left to right then right to left. This part
+ * is sequential, each cell depends on the one before.
+ */
+bool relax_along_row(float* row, const float* costs, const int count,
+                     const float max_distance) {
+    bool changed = false;
+    for(int x = 0; x < count; ++x) {
+        const float candidate = row[x - 1] + costs[x];
+        if(candidate < row[x] && candidate <= max_distance) {
+            row[x]  = candidate;
+            changed = true;
+        }
+    }
+    for(int x = count - 1; x >= 0; --x) {
+        const float candidate = row[x + 1] + costs[x];
+        if(candidate < row[x] && candidate <= max_distance) {
+            row[x]  = candidate;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+}  // namespace
+
+dijkstra_map_t::dijkstra_map_t(const int width, const int height) {
+    resize(width, height);
+}
+
+void dijkstra_map_t::resize(const int width, const int height) {
+    m_width        = width;
+    m_height       = height;
+    m_stride       = width + 2;
+    const size_t n = static_cast<size_t>(m_stride) * (height + 2);
+    m_distances.assign(n, unreachable);
+    m_costs.assign(n, unreachable);
+    for(int y = 0; y < height; ++y) {
+        std::fill_n(m_costs.begin() + at(0, y), width, 1.f);
+    }
+}
+
+void dijkstra_map_t::clear() {
+    std::fill(m_distances.begin(), m_distances.end(), unreachable);
+}
+
+bool dijkstra_map_t::sweep(const bool down, const float max_distance) {
+    bool changed = false;
+    for(int i = 0; i < m_height; ++i) {
+        const int y        = down ? i : m_height - 1 - i;
+        float* row         = &m_distances[at(0, y)];
+        const float* costs = &m_costs[at(0, y)];
+        const float* other = row + (down ? -m_stride : m_stride);
+        changed |= relax_from_row(row, other, costs, m_width, max_distance);
+        changed |= relax_along_row(row, costs, m_width, max_distance);
+    }
+    return changed;
+}
+
+void dijkstra_map_t::flood() {
+    using heap_t = radix_heap_t<int>;
+    // Radix heap keys can't go below zero and flee maps do: the keys are the
+    // distances above the lowest one
+    float lowest = unreachable;
+    for(const float distance : m_distances) {
+        lowest = std::min(lowest, distance);
+    }
+    if(lowest == unreachable) {
+        return;
+    }
+    const auto key = [lowest](const float distance) {
+        return heap_t::float_key(distance - lowest);
+    };
+    m_open.clear();
+    for(int cell = 0; cell < static_cast<int>(m_distances.size()); ++cell) {
+        if(m_distances[cell] != unreachable) {
+            m_open.push(key(m_distances[cell]), cell);
+        }
+    }
+    // the 8 neighbours of a cell in the grid_dx/grid_dy order, the padding
+    // keeps them inside the arrays
+    int offsets[8];
+    for(int d = 0; d < 8; ++d) {
+        offsets[d] = grid_dy[d] * m_stride + grid_dx[d];
+    }
+    while(!m_open.empty()) {
+        const auto [cell_key, cell] = m_open.pop();
+        const float distance        = m_distances[cell];
+        if(key(distance) != cell_key) {
+            // lowered since it was pushed
+            continue;
+        }
+        for(int d = 0; d < 8; ++d) {
+            const int next   = cell + offsets[d];
+            const float cost = m_costs[next];
+            if(cost == unreachable) {
+                continue;
+            }
+            const float candidate = distance + cost * grid_step_cost(d);
+            if(candidate < m_distances[next]) {
+                m_distances[next] = candidate;
+                m_open.push(key(candidate), next);
+            }
+        }
+    }
+}
+
+void dijkstra_map_t::compute(const float max_distance) {
+    if(max_distance == unreachable) {
+        flood();
+        return;
+    }
+    // Alternate downward and upward sweeps until nothing changes, the cutoff
+    // keeps the changes to a few passes around the sources
+    bool changed = true;
+    while(changed) {
+        changed = sweep(true, max_distance);
+        changed |= sweep(false, max_distance);
+    }
+}
+
+void dijkstra_map_t::make_flee(const float coefficient) {
+    for(float& distance : m_distances) {
+        if(distance != unreachable) {
+            distance *= coefficient;
+        }
+    }
+    compute();
+}
+
+std::pair<int, int> dijkstra_map_t::downhill(const int x, const int y) const {
+    std::pair<int, int> best{x, y};
+    float lowest = m_distances[at(x, y)];
+    for(int dy = -1; dy <= 1; ++dy) {
+        for(int dx = -1; dx <= 1; ++dx) {
+            // the padding is unreachable, never lower
+            const float distance = m_distances[at(x + dx, y + dy)];
+            if(distance < lowest) {
+                lowest = distance;
+                best   = {x + dx, y + dy};
+            }
+        }
+    }
+    return best;
+}
+
+}  // namespace radl
@@ -0,0 +1,148 @@
+/*
+ * Dijkstra maps (flow fields): one multi-source scan of the grid gives the
+ * distance of every cell to the nearest source, then any number of agents
+ * walk downhill to a source in O(1) per step, instead of one path_find each.
+ *
+ * Moves are 8-connected, stepping onto a cell costs its cost multiplier
+ * (sqrt(2) times that for diagonals). A flee map is made from a computed map
+ * by make_flee(): agents walking it downhill head away from the sources,
+ * towards the far ends of the map rather than into dead ends.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "radix_heap.hpp"
+
+namespace radl {
+
+class dijkstra_map_t {
+public:
+    static constexpr float unreachable = std::numeric_limits<float>::infinity();
+
+private:
+    int m_width  = 0;
+    int m_height = 0;
+    // Rows are padded with one unreachable cell on each side and there is a
+    // padding row above and below, so the scans need no edge cases
+    int m_stride = 0;
+    std::vector<float> m_distances;
+    // Cost multiplier of stepping onto each cell, unreachable for walls
+    std::vector<float> m_costs;
+    // open cells of flood(), kept for their memory
+    radix_heap_t<int> m_open;
+
+    inline int at(const int x, const int y) const noexcept {
+        return (y + 1) * m_stride + x + 1;
+    }
+
+    // One sweep over the rows, top to bottom (@p down) or bottom to top.
+    // Returns true if a distance changed.
+    bool sweep(bool down, float max_distance);
+
+    // Dijkstra from every reachable cell, each cell is settled once
+    void flood();
+
+public:
+    dijkstra_map_t(int width, int height);
+
+    /**
+     * @brief Resizes the map: every cell walkable with cost 1 and unreachable.
+     */
+    void resize(int width, int height);
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    /**
+     * @brief Sets the cost multiplier (>= 1 keeps distances in tiles) of
+     * stepping onto x/y, unreachable makes it a wall.
+     */
+    inline void set_cost(const int x, const int y, const float cost) {
+        m_costs[at(x, y)] = cost;
+    }
+
+    inline float cost(const int x, const int y) const {
+        return m_costs[at(x, y)];
+    }
+
+    inline void set_walkable(const int x, const int y, const bool walkable) {
+        set_cost(x, y, walkable ? 1.f : unreachable);
+    }
+
+    /**
+     * @brief Reads the walkability (and tile costs, if any) of the whole map
+     * from a grid navigator.
+     */
+    template <typename location_t, typename navigator_t>
+        requires grid_navigator<navigator_t, location_t>
+    void set_costs() {
+        for(int y = 0; y < m_height; ++y) {
+            for(int x = 0; x < m_width; ++x) {
+                const location_t loc = navigator_t::get_xy(x, y);
+                float cost           = 1.f;
+                if constexpr(weighted_grid_navigator<navigator_t,
+                                                     location_t>) {
+                    cost = static_cast<float>(
+                        navigator_t::get_tile_cost(loc));
+                }
+                set_cost(x, y,
+                         navigator_t::is_walkable(loc) ? cost : unreachable);
+            }
+        }
+    }
+
+    /**
+     * @brief Makes every cell unreachable, before adding the sources.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a source (a goal for agents walking downhill). Sources may
+     * start above 0 to make them less attractive.
+     */
+    inline void add_source(const int x, const int y, const float value = 0.f) {
+        float& distance = m_distances[at(x, y)];
+        distance        = std::min(distance, value);
+    }
+
+    /**
+     * @brief Computes the distances from the sources, cells further than
+     * @p max_distance stay unreachable. Only lowers the current values, so it
+     * can be run again after adding sources.
+     *
+     * The whole map is a Dijkstra over a radix heap, O(cells) on any layout.
+     * With a cutoff the field stays local, it is relaxed by row-vectorized
+     * sweeps instead, repeated until nothing changes.
+     */
+    void compute(float max_distance = unreachable);
+
+    /**
+     * @brief Turns a computed map into a flee map: the reachable distances
+     * are scaled by @p coefficient (negative) and the map is rescanned.
+     * Around -1.2 agents prefer the far ends of the map over nearby corners.
+     */
+    void make_flee(float coefficient = -1.2f);
+
+    inline float distance(const int x, const int y) const {
+        return m_distances[at(x, y)];
+    }
+
+    /**
+     * @brief The lowest of the 8 neighbours of x/y, or x/y itself when none
+     * is lower (a source, or an unreachable cell).
+     */
+    std::pair<int, int> downhill(int x, int y) const;
+};
+
+}  // namespace radl
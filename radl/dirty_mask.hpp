@@ -0,0 +1,154 @@
+/*
+ * Tracks which cells of a grid were touched since the last clear: one bit per
+ * cell plus the min/max touched column of every row.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace radl {
+
+class dirty_mask_t {
+public:
+    // Touched columns of a row, [min, max]. Empty when min > max.
+    struct span_t {
+        int min = INT32_MAX;
+        int max = -1;
+
+        inline bool empty() const noexcept {
+            return min > max;
+        }
+    };
+
+private:
+    int m_width  = 0;
+    int m_height = 0;
+    // Every row starts on its own word, so rows can be marked independently
+    int m_words_per_row = 0;
+    std::vector<uint64_t> m_bits;
+    std::vector<span_t> m_spans;
+
+public:
+    inline void resize(const int width, const int height) {
+        m_width         = width;
+        m_height        = height;
+        m_words_per_row = (width + 63) / 64;
+        m_bits.assign(static_cast<size_t>(m_words_per_row) * height, 0);
+        m_spans.assign(height, span_t{});
+    }
+
+    inline void mark(const int x, const int y) noexcept {
+        m_bits[y * m_words_per_row + (x >> 6)] |= uint64_t{1} << (x & 63);
+        auto& span = m_spans[y];
+        span.min   = std::min(span.min, x);
+        span.max   = std::max(span.max, x);
+    }
+
+    /**
+     * @brief Marks the columns [x0, x1] of row @p y.
+     */
+    inline void mark_row(const int y, const int x0, const int x1) noexcept {
+        uint64_t* row = &m_bits[y * m_words_per_row];
+        for(int x = x0; x <= x1;) {
+            const int bit   = x & 63;
+            const int count = std::min(64 - bit, x1 - x + 1);
+            const uint64_t bits
+                = count == 64 ? ~uint64_t{0} : ((uint64_t{1} << count) - 1);
+            row[x >> 6] |= bits << bit;
+            x += count;
+        }
+        auto& span = m_spans[y];
+        span.min   = std::min(span.min, x0);
+        span.max   = std::max(span.max, x1);
+    }
+
+    /**
+     * @brief Marks column x + i of row @p y for every bit i set in @p bits,
+     * @p x must be a multiple of 32.
+     */
+    inline void mark_bits(const int x, const int y,
+                          const uint32_t bits) noexcept {
+        if(bits == 0) {
+            return;
+        }
+        m_bits[y * m_words_per_row + (x >> 6)] |= uint64_t{bits} << (x & 63);
+        auto& span = m_spans[y];
+        span.min   = std::min(span.min, x + std::countr_zero(bits));
+        span.max   = std::max(span.max, x + 31 - std::countl_zero(bits));
+    }
+
+    inline void mark_all() noexcept {
+        for(int y = 0; y < m_height; ++y) {
+            mark_row(y, 0, m_width - 1);
+        }
+    }
+
+    inline bool test(const int x, const int y) const noexcept {
+        return (m_bits[y * m_words_per_row + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    /**
+     * @brief The marks of the columns [x, x + 32) of row @p y, @p x must be a
+     * multiple of 32.
+     */
+    inline uint32_t bits32(const int x, const int y) const noexcept {
+        return static_cast<uint32_t>(m_bits[y * m_words_per_row + (x >> 6)]
+                                     >> (x & 63));
+    }
+
+    inline const span_t& row_span(const int y) const noexcept {
+        return m_spans[y];
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    /**
+     * @brief Clears the marks of row @p y, only the words inside its span are
+     * written.
+     */
+    inline void clear_row(const int y) noexcept {
+        auto& span = m_spans[y];
+        if(span.empty()) {
+            return;
+        }
+        uint64_t* row = &m_bits[y * m_words_per_row];
+        std::fill(row + (span.min >> 6), row + (span.max >> 6) + 1, 0);
+        span = span_t{};
+    }
+
+    inline void clear() noexcept {
+        for(int y = 0; y < m_height; ++y) {
+            clear_row(y);
+        }
+    }
+
+    /**
+     * @brief Calls @p func(x, y) for every marked cell, row by row.
+     */
+    template <typename F>
+    inline void for_each(F&& func) const {
+        for(int y = 0; y < m_height; ++y) {
+            const auto& span = m_spans[y];
+            if(span.empty()) {
+                continue;
+            }
+            const uint64_t* row = &m_bits[y * m_words_per_row];
+            for(int word = span.min >> 6; word <= (span.max >> 6); ++word) {
+                uint64_t bits = row[word];
+                while(bits) {
+                    const int x = (word << 6) + std::countr_zero(bits);
+                    func(x, y);
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+};
+
+}  // namespace radl
@@ -0,0 +1,361 @@
+/*
+ * Incremental replanning on grids (D* Lite, Koenig & Likhachev 2002).
+ *
+ * The search runs backwards from the goal and keeps its state between calls:
+ * when the agent moves along the path, or tiles change under it (a door
+ * opens, a wall is dug), the next plan() only repairs the part of the search
+ * tree the change affects instead of starting over. A different goal starts
+ * a new search.
+ *
+ * Keep one dstar_lite_t per agent (the goal is part of the state).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "path_finding.hpp"
+
+namespace radl {
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class dstar_lite_t {
+private:
+    static constexpr bool diagonal  = grid_diagonal_moves<navigator_t>();
+    static constexpr int directions = diagonal ? 8 : 4;
+    static constexpr float no_path  = std::numeric_limits<float>::infinity();
+
+    using key_t = std::pair<float, float>;
+
+    int m_width  = 0;
+    int m_height = 0;
+    // cost to the goal, and its one step lookahead
+    std::vector<float> m_g;
+    std::vector<float> m_rhs;
+    // open list: binary heap of cells, with each cell's key and position
+    std::vector<int> m_open;
+    std::vector<key_t> m_keys;
+    std::vector<int> m_heap_index;
+
+    bool m_started = false;
+    int m_goal     = -1;
+    int m_start    = -1;
+    // start of the last plan, and the key offset the moves since add up to
+    int m_last        = -1;
+    float m_key_shift = 0.f;
+    // tiles changed since the last plan
+    std::vector<int> m_changed;
+    size_t m_expanded = 0;
+
+    inline bool walkable(const int x, const int y) const {
+        return x >= 0 && y >= 0 && x < m_width && y < m_height
+               && navigator_t::is_walkable(navigator_t::get_xy(x, y));
+    }
+
+    // Cost of moving from @p from onto its neighbour in direction @p d
+    inline float cost(const int from, const int d) const {
+        const int x  = from % m_width;
+        const int y  = from / m_width;
+        const int nx = x + grid_dx[d];
+        const int ny = y + grid_dy[d];
+        if(!walkable(x, y) || !walkable(nx, ny)) {
+            return no_path;
+        }
+        float result = grid_step_cost(d);
+        if constexpr(weighted_grid_navigator<navigator_t, location_t>) {
+            result *= static_cast<float>(
+                navigator_t::get_tile_cost(navigator_t::get_xy(nx, ny)));
+        }
+        return result;
+    }
+
+    inline bool neighbour(const int cell, const int d, int& next) const {
+        const int nx = cell % m_width + grid_dx[d];
+        const int ny = cell / m_width + grid_dy[d];
+        if(nx < 0 || ny < 0 || nx >= m_width || ny >= m_height) {
+            return false;
+        }
+        next = ny * m_width + nx;
+        return true;
+    }
+
+    // grid_distance, shrunk a little with diagonal moves. Unlike the one
+    // shot searches, the repairs rely on the heuristic being consistent, and
+    // with float rounding the octile distance can exceed the summed step
+    // costs by an ulp
+    inline float heuristic(const int a, const int b) const noexcept {
+        constexpr float shrink = diagonal ? 0.999f : 1.f;
+        return shrink
+               * grid_distance<diagonal>(a % m_width - b % m_width,
+                                         a / m_width - b / m_width);
+    }
+
+    inline key_t calculate_key(const int cell) const noexcept {
+        const float best = std::min(m_g[cell], m_rhs[cell]);
+        return {best + heuristic(m_start, cell) + m_key_shift, best};
+    }
+
+    void heap_set(const size_t index, const int cell) {
+        m_open[index]      = cell;
+        m_heap_index[cell] = static_cast<int>(index);
+    }
+
+    void sift_up(size_t index) {
+        const int cell = m_open[index];
+        while(index > 0) {
+            const size_t parent = (index - 1) / 2;
+            if(!(m_keys[cell] < m_keys[m_open[parent]])) {
+                break;
+            }
+            heap_set(index, m_open[parent]);
+            index = parent;
+        }
+        heap_set(index, cell);
+    }
+
+    void sift_down(size_t index) {
+        const int cell = m_open[index];
+        const size_t n = m_open.size();
+        while(true) {
+            size_t child = index * 2 + 1;
+            if(child >= n) {
+                break;
+            }
+            if(child + 1 < n
+               && m_keys[m_open[child + 1]] < m_keys[m_open[child]]) {
+                ++child;
+            }
+            if(!(m_keys[m_open[child]] < m_keys[cell])) {
+                break;
+            }
+            heap_set(index, m_open[child]);
+            index = child;
+        }
+        heap_set(index, cell);
+    }
+
+    // Inserts @p cell with @p key, or moves it if it is already open
+    void open_set(const int cell, const key_t& key) {
+        const int index = m_heap_index[cell];
+        m_keys[cell]    = key;
+        if(index < 0) {
+            m_open.push_back(cell);
+            sift_up(m_open.size() - 1);
+        } else {
+            sift_up(static_cast<size_t>(index));
+            sift_down(static_cast<size_t>(m_heap_index[cell]));
+        }
+    }
+
+    void open_remove(const int cell) {
+        const int index = m_heap_index[cell];
+        if(index < 0) {
+            return;
+        }
+        m_heap_index[cell] = -1;
+        const int last     = m_open.back();
+        m_open.pop_back();
+        if(last != cell) {
+            heap_set(static_cast<size_t>(index), last);
+            sift_up(static_cast<size_t>(index));
+            sift_down(static_cast<size_t>(m_heap_index[last]));
+        }
+    }
+
+    void update_vertex(const int cell) {
+        if(cell != m_goal) {
+            float best = no_path;
+            int next   = 0;
+            for(int d = 0; d < directions; ++d) {
+                if(neighbour(cell, d, next)) {
+                    best = std::min(best, cost(cell, d) + m_g[next]);
+                }
+            }
+            m_rhs[cell] = best;
+        }
+        if(m_g[cell] != m_rhs[cell]) {
+            open_set(cell, calculate_key(cell));
+        } else {
+            open_remove(cell);
+        }
+    }
+
+    // Updates the cells whose rhs may depend on @p cell
+    void update_predecessors(const int cell) {
+        int previous = 0;
+        for(int d = 0; d < directions; ++d) {
+            if(neighbour(cell, d, previous)) {
+                update_vertex(previous);
+            }
+        }
+    }
+
+    bool compute_shortest_path(const size_t limit_steps) {
+        while(!m_open.empty()
+              && (m_keys[m_open.front()] < calculate_key(m_start)
+                  || m_rhs[m_start] != m_g[m_start])) {
+            if(++m_expanded > limit_steps) {
+                return false;
+            }
+            const int cell      = m_open.front();
+            const key_t old_key = m_keys[cell];
+            const key_t new_key = calculate_key(cell);
+            if(old_key < new_key) {
+                // the start moved since it was queued
+                open_set(cell, new_key);
+            } else if(m_g[cell] > m_rhs[cell]) {
+                m_g[cell] = m_rhs[cell];
+                open_remove(cell);
+                update_predecessors(cell);
+            } else {
+                m_g[cell] = no_path;
+                update_vertex(cell);
+                update_predecessors(cell);
+            }
+        }
+        return m_rhs[m_start] != no_path;
+    }
+
+    void restart(const int start, const int goal) {
+        std::fill(m_g.begin(), m_g.end(), no_path);
+        std::fill(m_rhs.begin(), m_rhs.end(), no_path);
+        for(const int cell : m_open) {
+            m_heap_index[cell] = -1;
+        }
+        m_open.clear();
+        m_changed.clear();
+        m_started   = true;
+        m_goal      = goal;
+        m_start     = start;
+        m_last      = start;
+        m_key_shift = 0.f;
+        m_rhs[goal] = 0.f;
+        open_set(goal, calculate_key(goal));
+    }
+
+public:
+    dstar_lite_t(const int width, const int height) {
+        resize(width, height);
+    }
+
+    /**
+     * @brief Sets the size of the map, dropping the search state.
+     */
+    void resize(const int width, const int height) {
+        m_width        = width;
+        m_height       = height;
+        const size_t n = static_cast<size_t>(width) * height;
+        m_g.assign(n, no_path);
+        m_rhs.assign(n, no_path);
+        m_keys.assign(n, key_t{});
+        m_heap_index.assign(n, -1);
+        m_open.clear();
+        m_changed.clear();
+        m_started = false;
+    }
+
+    /**
+     * @brief Drops the search state, the next plan() starts over.
+     */
+    void reset() {
+        m_started = false;
+    }
+
+    /**
+     * @brief Tells the planner the walkability (or cost) of x/y changed. The
+     * search is repaired by the next plan(). Off-map tiles are ignored.
+     */
+    void update_tile(const int x, const int y) {
+        if(x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return;
+        }
+        if(m_started) {
+            m_changed.push_back(y * m_width + x);
+        }
+    }
+
+    /**
+     * @brief Number of cells expanded by the last plan().
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief Finds a shortest path from @p start to @p end, reusing the
+     * previous search when @p end did not change.
+     *
+     * @param limit_steps give up after expanding this many cells; the search
+     * state stays valid and the next plan() carries on
+     * @return the path, start and end included
+     */
+    astar_path_t<location_t> plan(
+        const location_t& start, const location_t& end,
+        const size_t limit_steps = std::numeric_limits<size_t>::max()) {
+        auto result  = astar_path_t<location_t>{false, end};
+        m_expanded   = 0;
+        const int sx = navigator_t::get_x(start);
+        const int sy = navigator_t::get_y(start);
+        const int gx = navigator_t::get_x(end);
+        const int gy = navigator_t::get_y(end);
+        if(sx < 0 || sy < 0 || sx >= m_width || sy >= m_height || gx < 0
+           || gy < 0 || gx >= m_width || gy >= m_height) {
+            return result;
+        }
+        const int first = sy * m_width + sx;
+        const int goal  = gy * m_width + gx;
+
+        if(!m_started || goal != m_goal) {
+            restart(first, goal);
+        } else {
+            // keys already queued are lower bounds by this much at most
+            m_start = first;
+            m_key_shift += heuristic(m_last, first);
+            m_last = first;
+            for(const int cell : m_changed) {
+                update_vertex(cell);
+                update_predecessors(cell);
+            }
+            m_changed.clear();
+        }
+        if(!compute_shortest_path(limit_steps)) {
+            return result;
+        }
+
+        // Walk down the cost to the goal
+        int cell = first;
+        result.steps.push_back(start);
+        while(cell != goal) {
+            int best        = -1;
+            float best_cost = no_path;
+            int next        = 0;
+            for(int d = 0; d < directions; ++d) {
+                if(neighbour(cell, d, next)) {
+                    const float total = cost(cell, d) + m_g[next];
+                    if(total < best_cost) {
+                        best_cost = total;
+                        best      = next;
+                    }
+                }
+            }
+            if(best < 0 || result.steps.size() > m_g.size()) {
+                result.steps.clear();
+                return result;
+            }
+            cell = best;
+            result.steps.push_back(
+                navigator_t::get_xy(cell % m_width, cell / m_width));
+        }
+        result.success = true;
+        return result;
+    }
+};
+
+}  // namespace radl
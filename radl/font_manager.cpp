@@ -1,3 +1,4 @@
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <stdexcept>
@@ -6,6 +7,7 @@
 
 // #include "boost/algorithm/string/split.hpp"
 // #include "boost/algorithm/string/trim.hpp"
+#include "external/glad.h"
 #include "filesystem.hpp"
 #include "font_manager.hpp"
 #include "texture_resources.hpp"
@@ -42,26 +44,130 @@ inline void check_texture_exists(const std::string &texture_tag) {
   }
 }
 
-void register_font(const std::string &font_tag, const std::string &filename,
-                   int tile_width, int tile_height) {
-  const std::string texture_tag = "font_tex_" + filename;
+void bitmap_font::build_glyph_table(const int atlas_width,
+                                    const int atlas_height) {
+  const auto &[font_width, font_height] = character_size;
+  columns = atlas_width / font_width;
+  const int rows = atlas_height / font_height;
+  if (columns == 0 || rows == 0) {
+    throw std::runtime_error("Font atlas smaller than a glyph: " +
+                             texture_tag);
+  }
+  glyph_origins.clear();
+  glyph_origins.reserve(static_cast<size_t>(columns) * rows);
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < columns; ++x) {
+      glyph_origins.push_back(Vector2{static_cast<float>(x * font_width),
+                                      static_cast<float>(y * font_height)});
+    }
+  }
+}
+
+Image load_font_image(const bitmap_font &font) {
+  const auto &[glyph_width, glyph_height] = font.character_size;
+  if (glyph_width <= 0 || glyph_height <= 0) {
+    throw std::runtime_error("Font glyph size not positive: " +
+                             font.texture_tag);
+  }
+  std::vector<Image> pages;
+  const auto unload_pages = [&pages]() {
+    for (auto &page : pages) {
+      UnloadImage(page);
+    }
+  };
+  int height = 0;
+  for (const auto &filename : font.pages) {
+    Image page = LoadImage(filename.c_str());
+    if (page.data == nullptr) {
+      unload_pages();
+      throw std::runtime_error("Unable to load font image from: " + filename);
+    }
+    ImageFormat(&page, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    pages.push_back(page);
+    if (page.width != pages.front().width) {
+      unload_pages();
+      throw std::runtime_error("Font page not as wide as the first one: " +
+                               filename);
+    }
+    // a partial glyph row would shift the glyphs of the next pages
+    if (page.height % glyph_height != 0) {
+      unload_pages();
+      throw std::runtime_error(
+          "Font page height not a multiple of the glyph height: " + filename);
+    }
+    height += page.height;
+  }
+  // the limit is only known once GL is up, without a window nothing is
+  // uploaded
+  if (IsWindowReady()) {
+    int max_size = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+    if (pages.front().width > max_size || height > max_size) {
+      unload_pages();
+      throw std::runtime_error("Font atlas larger than the GPU allows (" +
+                               std::to_string(max_size) +
+                               " pixels): " + font.texture_tag);
+    }
+  }
+  if (pages.size() == 1) {
+    return pages.front();
+  }
+
+  // stack the pages, their rows are contiguous in RGBA8 images
+  Image atlas = GenImageColor(pages.front().width, height, BLANK);
+  auto *pixels = static_cast<unsigned char *>(atlas.data);
+  for (const auto &page : pages) {
+    const size_t bytes = static_cast<size_t>(page.width) * page.height * 4;
+    std::memcpy(pixels, page.data, bytes);
+    pixels += bytes;
+  }
+  unload_pages();
+  return atlas;
+}
+
+void register_font(const std::string &font_tag,
+                   const std::vector<std::string> &pages, int tile_width,
+                   int tile_height, bool load_texture) {
+  if (pages.empty()) {
+    throw std::runtime_error("Font without any image: " + font_tag);
+  }
+  const std::string texture_tag = "font_tex_" + pages.front();
   check_for_duplicate_font(font_tag);
-  register_texture(filename, texture_tag);
-  check_texture_exists(texture_tag);
-  font_detail::atlas.emplace(std::make_pair(
-      font_tag, bitmap_font(texture_tag, tile_width, tile_height)));
+  bitmap_font font(texture_tag, pages, tile_width, tile_height);
+
+  // the image is loaded on the CPU either way, for the glyph table
+  Image image = load_font_image(font);
+  font.build_glyph_table(image.width, image.height);
+  if (load_texture) {
+    try {
+      register_texture(image, texture_tag);
+    } catch (...) {
+      UnloadImage(image);
+      throw;
+    }
+    check_texture_exists(texture_tag);
+  }
+  UnloadImage(image);
+  font_detail::atlas.emplace(std::make_pair(font_tag, std::move(font)));
 }
 
-void RegisterFonts(const std::string &filepath) {
+void RegisterFonts(const std::string &filepath, bool load_textures) {
   const std::filesystem::path path{filepath};
 
   auto ifstream = std::ifstream{filepath};
   auto json = nlohmann::json::parse(ifstream);
 
   for (auto &entry : json.at("fonts")) {
-    register_font(entry.at("name"),
-                  (path.parent_path() / entry.at("file")).string(),
-                  entry.at("width"), entry.at("height"));
+    std::vector<std::string> pages;
+    if (entry.contains("pages")) {
+      for (auto &page : entry.at("pages")) {
+        pages.push_back((path.parent_path() / page).string());
+      }
+    } else {
+      pages.push_back((path.parent_path() / entry.at("file")).string());
+    }
+    register_font(entry.at("name"), pages, entry.at("width"),
+                  entry.at("height"), load_textures);
   }
 }
 
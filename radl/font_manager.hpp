@@ -7,9 +7,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 // #include <utility>
 
+#include "raylib.h"
+#include "vchar.hpp"
+
 namespace radl {
 
 namespace {
@@ -21,30 +26,84 @@ constexpr int default_height = 8;
 
 struct bitmap_font {
   const std::string texture_tag;
+  // image files of the font pages, stacked top to bottom in a single atlas
+  const std::vector<std::string> pages;
   const std::pair<int, int> character_size;
+  // glyphs per atlas row
+  int columns = 16;
+  // top left corner of every glyph in the atlas, indexed by glyph id: glyph
+  // ids continue from one page to the next
+  std::vector<Vector2> glyph_origins;
 
-  bitmap_font(const std::string &tag, const int tile_width,
-              const int tile_height)
-      : texture_tag(tag),
+  bitmap_font(const std::string &tag, const std::vector<std::string> &files,
+              const int tile_width, const int tile_height)
+      : texture_tag(tag), pages(files),
         character_size(std::make_pair(tile_width, tile_height)) {}
+
+  /**
+   * @brief Fills glyph_origins for an atlas of @p atlas_width x
+   * @p atlas_height pixels.
+   */
+  void build_glyph_table(int atlas_width, int atlas_height);
+
+  /**
+   * @brief Top left corner of @p glyph in the atlas, glyph ids past the end of
+   * the atlas show glyph 0.
+   */
+  inline const Vector2 &glyph_origin(const uint32_t glyph) const noexcept {
+    return glyph < glyph_origins.size() ? glyph_origins[glyph]
+                                        : glyph_origins[0];
+  }
 };
 
 /**
- * @brief register the font directory with the file fonts.txt in the proper
- * CSV format:
- * "tag,filename,char_width,char_height"
+ * @brief register the font directory with the file fonts.json:
+ * {"fonts": [{"name": tag, "file": filename, "width": w, "height": h}]}
+ * A font with more than 256 glyphs lists its page images in "pages" instead of
+ * "file", every page must be as wide as the first one.
  *
  * @warning Doesn't work before InitWindow because GL isn't initialized...
  * It needs to registers the font as a texture, and OpenGL needs to be
  * initialized to store the texture
  *
  * @param path path where the fonts.txt file is located
+ * @param load_textures if false, no texture is created and no window is needed:
+ * the fonts can then only be drawn by the software_rasterizer
  */
-void RegisterFonts(const std::string &filepath);
+void RegisterFonts(const std::string &filepath, bool load_textures = true);
 
 bitmap_font *get_font(const std::string &font_tag);
 
-void register_font(const std::string &font_tag, const std::string &filename,
-                   int tile_width, int tile_height);
+/**
+ * @brief Moves @p rect to the source position of the @p vchar glyph inside the
+ * font texture.
+ */
+inline void set_rectangle_position_from_vchar(Rectangle &rect,
+                                              const vchar_t &vchar,
+                                              const bitmap_font &font) {
+  const auto &origin = font.glyph_origin(vchar.glyph);
+  rect.x = origin.x;
+  rect.y = origin.y;
+}
+
+/**
+ * @brief Loads the pages of @p font as one RGBA8 atlas image, the way its
+ * texture is built. The caller unloads the image. Throws if a page can't be
+ * loaded, is not as wide as the first one or not a whole number of glyph rows
+ * high, or if the atlas is larger than GL_MAX_TEXTURE_SIZE (checked once a
+ * window is open).
+ */
+Image load_font_image(const bitmap_font &font);
+
+void register_font(const std::string &font_tag,
+                   const std::vector<std::string> &pages, int tile_width,
+                   int tile_height, bool load_texture = true);
+
+inline void register_font(const std::string &font_tag,
+                          const std::string &filename, int tile_width,
+                          int tile_height, bool load_texture = true) {
+  register_font(font_tag, std::vector<std::string>{filename}, tile_width,
+                tile_height, load_texture);
+}
 
 } // namespace radl
@@ -0,0 +1,183 @@
+#include "gpu_resident_renderer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "texture_resources.hpp"
+
+namespace radl {
+
+namespace {
+
+Texture2D load_data_texture(std::vector<color_t>& pixels, const int columns,
+                            const int rows) {
+    const Image image{
+        pixels.data(), columns, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+    auto texture = LoadTextureFromImage(image);
+    if(texture.id == 0) {
+        throw std::runtime_error("Unable to create terminal data texture");
+    }
+    return texture;
+}
+
+}  // namespace
+
+gpu_resident_renderer::~gpu_resident_renderer() {
+    unload();
+}
+
+void gpu_resident_renderer::unload() {
+    // checks if texture is valid is done internal to raylib
+    UnloadTexture(m_glyphs);
+    UnloadTexture(m_foregrounds);
+    UnloadTexture(m_backgrounds);
+    UnloadTexture(m_palette);
+    m_glyphs      = Texture2D{0};
+    m_foregrounds = Texture2D{0};
+    m_backgrounds = Texture2D{0};
+    m_palette     = Texture2D{0};
+}
+
+void gpu_resident_renderer::resize(const int columns, const int rows) {
+    unload();
+    m_columns         = columns;
+    m_rows            = rows;
+    // the contents are uploaded by the first render
+    std::vector<color_t> pixels(static_cast<size_t>(columns) * rows);
+    m_glyphs      = load_data_texture(pixels, columns, rows);
+    m_foregrounds = load_data_texture(pixels, columns, rows);
+    m_backgrounds = load_data_texture(pixels, columns, rows);
+    pixels.resize(palette_t::max_size);
+    m_palette = load_data_texture(pixels, palette_t::max_size, 1);
+    m_uploaded.resize(static_cast<size_t>(columns) * rows);
+    m_uploaded_palette.clear();
+    m_stale = true;
+
+    m_shader   = get_shader("terminal_gpu");
+    m_uniforms = uniforms_t{
+        GetShaderLocation(m_shader, "foregrounds"),
+        GetShaderLocation(m_shader, "backgrounds"),
+        GetShaderLocation(m_shader, "palette"),
+        GetShaderLocation(m_shader, "atlas"),
+        GetShaderLocation(m_shader, "terminalSize"),
+        GetShaderLocation(m_shader, "cellSize"),
+        GetShaderLocation(m_shader, "atlasColumns"),
+        GetShaderLocation(m_shader, "atlasGlyphs"),
+        GetShaderLocation(m_shader, "hasBackground"),
+        GetShaderLocation(m_shader, "paletted"),
+    };
+}
+
+void gpu_resident_renderer::upload(const cell_buffer_t& cells) {
+    const palette_t* palette = cells.palette();
+    if((palette == nullptr) != (m_uploaded.palette() == nullptr)) {
+        // only the mode of m_uploaded matters, its cells stay packed
+        m_uploaded.set_palette(palette);
+        m_stale = true;
+    }
+    if(palette) {
+        // a recolor keeps the cells, only the palette texture changes
+        const color_t* colors = palette->data();
+        if(!std::equal(colors, colors + palette->size(),
+                       m_uploaded_palette.begin(), m_uploaded_palette.end())) {
+            m_uploaded_palette.assign(colors, colors + palette->size());
+            UpdateTexture(m_palette, colors);
+        }
+    }
+
+    // The rows to upload
+    int first_row = m_rows;
+    int last_row  = 0;
+    if(m_stale) {
+        m_stale    = false;
+        m_uploaded = cells;
+        first_row  = 0;
+        last_row   = m_rows;
+    } else {
+        for(size_t chunk = 0; chunk < cells.size();
+            chunk += cell_buffer_t::chunk_size) {
+            const int count = static_cast<int>(std::min<size_t>(
+                cell_buffer_t::chunk_size, cells.size() - chunk));
+            for(uint32_t changed = cells.diff(m_uploaded, chunk, count);
+                changed != 0; changed &= changed - 1) {
+                const size_t index = chunk + std::countr_zero(changed);
+                const int row      = static_cast<int>(index) / m_columns;
+                m_uploaded.copy(index, cells);
+                first_row = std::min(first_row, row);
+                last_row  = row + 1;
+            }
+        }
+    }
+    if(first_row >= last_row) {
+        return;
+    }
+
+    // The planes are 32 bits per cell, the glyph index is read back from the
+    // rgb bytes (little endian). Palette cells only have the glyph plane, the
+    // colors are looked up in the palette texture.
+    const Rectangle rows{0.f, static_cast<float>(first_row),
+                         static_cast<float>(m_columns),
+                         static_cast<float>(last_row - first_row)};
+    const size_t offset = static_cast<size_t>(first_row) * m_columns;
+    UpdateTextureRec(m_glyphs, rows, cells.glyphs() + offset);
+    if(!palette) {
+        UpdateTextureRec(m_foregrounds, rows, cells.foregrounds() + offset);
+        UpdateTextureRec(m_backgrounds, rows, cells.backgrounds() + offset);
+    }
+}
+
+void gpu_resident_renderer::render(RenderTexture2D& target,
+                                   const bitmap_font& font,
+                                   const cell_buffer_t& cells,
+                                   const bool has_background) {
+    if(static_cast<size_t>(m_columns) * m_rows != cells.size()) {
+        throw std::runtime_error("GPU renderer not sized to terminal");
+    }
+
+    upload(cells);
+
+    const auto atlas = get_texture(font.texture_tag);
+    const int terminal_size[]{m_columns, m_rows};
+    const int cell_size[]{font.character_size.first,
+                          font.character_size.second};
+    const int columns    = font.columns;
+    const int glyphs     = static_cast<int>(font.glyph_origins.size());
+    const int background = has_background ? 1 : 0;
+    const int paletted   = cells.palette() ? 1 : 0;
+
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+    BeginShaderMode(m_shader);
+    // The extra samplers are bound by raylib when the batch is drawn
+    SetShaderValueTexture(m_shader, m_uniforms.foregrounds, m_foregrounds);
+    SetShaderValueTexture(m_shader, m_uniforms.backgrounds, m_backgrounds);
+    SetShaderValueTexture(m_shader, m_uniforms.palette, m_palette);
+    SetShaderValueTexture(m_shader, m_uniforms.atlas, atlas);
+    SetShaderValue(m_shader, m_uniforms.terminal_size, terminal_size,
+                   SHADER_UNIFORM_IVEC2);
+    SetShaderValue(m_shader, m_uniforms.cell_size, cell_size,
+                   SHADER_UNIFORM_IVEC2);
+    SetShaderValue(m_shader, m_uniforms.atlas_columns, &columns,
+                   SHADER_UNIFORM_INT);
+    SetShaderValue(m_shader, m_uniforms.atlas_glyphs, &glyphs,
+                   SHADER_UNIFORM_INT);
+    SetShaderValue(m_shader, m_uniforms.has_background, &background,
+                   SHADER_UNIFORM_INT);
+    SetShaderValue(m_shader, m_uniforms.paletted, &paletted,
+                   SHADER_UNIFORM_INT);
+    // One quad covering the whole terminal, texture0 is the glyph texture
+    DrawTexturePro(
+        m_glyphs,
+        Rectangle{0.f, 0.f, static_cast<float>(m_columns),
+                  static_cast<float>(m_rows)},
+        Rectangle{0.f, 0.f,
+                  static_cast<float>(m_columns * font.character_size.first),
+                  static_cast<float>(m_rows * font.character_size.second)},
+        Vector2{0.f, 0.f}, 0.f, WHITE);
+    EndShaderMode();
+    EndTextureMode();
+}
+
+}  // namespace radl
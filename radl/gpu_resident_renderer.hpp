@@ -0,0 +1,67 @@
+/*
+ * GPU resident renderer for virtual terminals: the cell planes are uploaded
+ * as-is as data textures (glyph indices, foreground and background colors,
+ * 32 bits per texel) and a fragment
+ * shader resolves every pixel against the font texture, drawing the whole
+ * terminal as a single quad.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "cell_renderer.hpp"
+
+namespace radl {
+
+class gpu_resident_renderer final : public cell_renderer {
+private:
+    // Uniform locations of the terminal_gpu shader
+    struct uniforms_t {
+        int foregrounds    = -1;
+        int backgrounds    = -1;
+        int palette        = -1;
+        int atlas          = -1;
+        int terminal_size  = -1;
+        int cell_size      = -1;
+        int atlas_columns  = -1;
+        int atlas_glyphs   = -1;
+        int has_background = -1;
+        int paletted       = -1;
+    };
+
+    Texture2D m_glyphs      = {0};
+    Texture2D m_foregrounds = {0};
+    Texture2D m_backgrounds = {0};
+    // 256 x 1 colors, only used for palette cells
+    Texture2D m_palette     = {0};
+    int m_columns           = 0;
+    int m_rows              = 0;
+    Shader m_shader{};
+    uniforms_t m_uniforms;
+    // What the data textures hold: the cells and palette colors of the last
+    // upload. Only the rows spanning the changed cells are uploaded again.
+    cell_buffer_t m_uploaded;
+    std::vector<color_t> m_uploaded_palette;
+    bool m_stale = true;
+
+    void unload();
+
+    // Brings the data textures up to date with @p cells
+    void upload(const cell_buffer_t& cells);
+
+public:
+    gpu_resident_renderer() = default;
+
+    gpu_resident_renderer(const gpu_resident_renderer&)            = delete;
+    gpu_resident_renderer& operator=(const gpu_resident_renderer&) = delete;
+
+    ~gpu_resident_renderer() override;
+
+    void resize(int columns, int rows) override;
+
+    void render(RenderTexture2D& target, const bitmap_font& font,
+                const cell_buffer_t& cells, bool has_background) override;
+};
+
+}  // namespace radl
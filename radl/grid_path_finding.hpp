@@ -0,0 +1,283 @@
+/*
+ * A* specialised for dense 2D tile maps, next to path_find for the common
+ * case. The navigator is checked by a concept and only has static functions,
+ * so every callback inlines. Scores and parents live in flat arrays indexed
+ * by y * width + x, stamped with a generation counter so nothing is cleared
+ * between searches, and the open list is a radix heap.
+ *
+ * Keep one grid_search_t per map (and per thread) and reuse it, a search then
+ * allocates nothing once the buffers have grown.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "radix_heap.hpp"
+
+namespace radl {
+
+/*
+ * What grid_search_t needs from a navigator. The same functions as the
+ * Bresenham helpers of path_find navigators:
+ *   static int get_x(const location_t&);
+ *   static int get_y(const location_t&);
+ *   static location_t get_xy(int x, int y);
+ *   static bool is_walkable(const location_t&);
+ *
+ * Optional:
+ *   static float get_tile_cost(const location_t&);
+ *     multiplier (>= 1) of the cost of stepping onto a tile, 1 by default
+ *   static constexpr bool diagonal_moves;
+ *     false restricts the moves to the 4 orthogonal directions
+ */
+template <typename navigator_t, typename location_t>
+concept grid_navigator
+    = requires(const location_t& loc, const int x, const int y) {
+          { navigator_t::get_x(loc) } -> std::convertible_to<int>;
+          { navigator_t::get_y(loc) } -> std::convertible_to<int>;
+          { navigator_t::get_xy(x, y) } -> std::convertible_to<location_t>;
+          { navigator_t::is_walkable(loc) } -> std::convertible_to<bool>;
+      };
+
+template <typename navigator_t, typename location_t>
+concept weighted_grid_navigator
+    = grid_navigator<navigator_t, location_t>
+      && requires(const location_t& loc) {
+             { navigator_t::get_tile_cost(loc) }
+                 -> std::convertible_to<float>;
+         };
+
+/*
+ * Rectangle of cells [x0, x1) x [y0, y1)
+ */
+struct grid_bounds_t {
+    int x0 = 0;
+    int y0 = 0;
+    int x1 = 0;
+    int y1 = 0;
+
+    inline bool contains(const int x, const int y) const noexcept {
+        return x >= x0 && y >= y0 && x < x1 && y < y1;
+    }
+};
+
+template <typename navigator_t>
+constexpr bool grid_diagonal_moves() {
+    if constexpr(requires { navigator_t::diagonal_moves; }) {
+        return navigator_t::diagonal_moves;
+    } else {
+        return true;
+    }
+}
+
+/*
+ * Moves of the grid path finders: the 4 orthogonal directions first, then
+ * the 4 diagonals.
+ */
+inline constexpr float grid_sqrt2 = 1.41421356f;
+inline constexpr int grid_dx[]{0, 1, 0, -1, 1, 1, -1, -1};
+inline constexpr int grid_dy[]{-1, 0, 1, 0, -1, 1, 1, -1};
+
+// Cost of a move in direction @p d, before the tile cost
+constexpr float grid_step_cost(const int d) noexcept {
+    return d < 4 ? 1.f : grid_sqrt2;
+}
+
+/**
+ * @brief Cost of the cheapest path over an offset of @p dx, @p dy cells on an
+ * open map: octile distance with diagonal moves, Manhattan otherwise. Never
+ * overestimates since tile costs are at least 1.
+ */
+template <bool diagonal>
+inline float grid_distance(int dx, int dy) noexcept {
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    if constexpr(diagonal) {
+        return static_cast<float>(dx + dy)
+               + (grid_sqrt2 - 2.f) * static_cast<float>(std::min(dx, dy));
+    } else {
+        return static_cast<float>(dx + dy);
+    }
+}
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class grid_search_t {
+private:
+    static constexpr bool diagonal = grid_diagonal_moves<navigator_t>();
+
+    int m_width  = 0;
+    int m_height = 0;
+    // cost from the start and parent cell, valid where m_visited is the
+    // current generation
+    std::vector<float> m_g;
+    std::vector<int> m_parent;
+    std::vector<uint32_t> m_visited;
+    // cells expanded in the current generation
+    std::vector<uint32_t> m_closed;
+    uint32_t m_generation = 0;
+    radix_heap_t<int> m_open;
+    size_t m_expanded = 0;
+
+    void next_generation() {
+        if(++m_generation == 0) {
+            // wrapped around, the stamps of old searches could match again
+            std::fill(m_visited.begin(), m_visited.end(), 0);
+            std::fill(m_closed.begin(), m_closed.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    static inline float heuristic(const int x, const int y, const int gx,
+                                  const int gy) noexcept {
+        return grid_distance<diagonal>(x - gx, y - gy);
+    }
+
+public:
+    grid_search_t(const int width, const int height) {
+        resize(width, height);
+    }
+
+    /**
+     * @brief Sets the size of the map, must be done when the map size changes.
+     */
+    void resize(const int width, const int height) {
+        m_width        = width;
+        m_height       = height;
+        const size_t n = static_cast<size_t>(width) * height;
+        m_g.assign(n, 0.f);
+        m_parent.assign(n, -1);
+        m_visited.assign(n, 0);
+        m_closed.assign(n, 0);
+        m_generation = 0;
+    }
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    /**
+     * @brief Number of cells expanded by the last search.
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief Finds a shortest path from @p start to @p end.
+     *
+     * @param steps filled with the path, start and end included; cleared when
+     * there is no path
+     * @param limit_steps give up after expanding this many cells
+     * @return true if a path was found
+     */
+    bool find(const location_t& start, const location_t& end,
+              std::vector<location_t>& steps,
+              const size_t limit_steps = std::numeric_limits<size_t>::max()) {
+        return find_within(grid_bounds_t{0, 0, m_width, m_height}, start, end,
+                           steps, limit_steps);
+    }
+
+    /**
+     * @brief find() restricted to the cells inside @p bounds (which must be
+     * inside the map).
+     */
+    bool find_within(
+        const grid_bounds_t& bounds, const location_t& start,
+        const location_t& end, std::vector<location_t>& steps,
+        const size_t limit_steps = std::numeric_limits<size_t>::max()) {
+        steps.clear();
+        m_expanded   = 0;
+        const int sx = navigator_t::get_x(start);
+        const int sy = navigator_t::get_y(start);
+        const int gx = navigator_t::get_x(end);
+        const int gy = navigator_t::get_y(end);
+        if(!bounds.contains(sx, sy) || !bounds.contains(gx, gy)) {
+            return false;
+        }
+
+        next_generation();
+        const uint32_t generation = m_generation;
+        const int goal            = gy * m_width + gx;
+        const int first           = sy * m_width + sx;
+        m_open.clear();
+        m_g[first]       = 0.f;
+        m_parent[first]  = -1;
+        m_visited[first] = generation;
+        m_open.push(radix_heap_t<int>::float_key(heuristic(sx, sy, gx, gy)),
+                    first);
+
+        constexpr int directions = diagonal ? 8 : 4;
+
+        while(!m_open.empty()) {
+            const int index = m_open.pop().second;
+            if(m_closed[index] == generation) {
+                continue;  // stale entry, the cell was reached cheaper
+            }
+            m_closed[index] = generation;
+            if(index == goal) {
+                for(int cell = goal; cell != -1; cell = m_parent[cell]) {
+                    steps.push_back(navigator_t::get_xy(cell % m_width,
+                                                        cell / m_width));
+                }
+                std::reverse(steps.begin(), steps.end());
+                return true;
+            }
+            if(++m_expanded > limit_steps) {
+                return false;
+            }
+
+            const int x   = index % m_width;
+            const int y   = index / m_width;
+            const float g = m_g[index];
+            for(int d = 0; d < directions; ++d) {
+                const int nx = x + grid_dx[d];
+                const int ny = y + grid_dy[d];
+                if(!bounds.contains(nx, ny)) {
+                    continue;
+                }
+                const int next = ny * m_width + nx;
+                if(m_closed[next] == generation) {
+                    continue;
+                }
+                const location_t loc = navigator_t::get_xy(nx, ny);
+                if(!navigator_t::is_walkable(loc)) {
+                    continue;
+                }
+                float cost = grid_step_cost(d);
+                if constexpr(weighted_grid_navigator<navigator_t,
+                                                     location_t>) {
+                    cost *= static_cast<float>(
+                        navigator_t::get_tile_cost(loc));
+                }
+                const float next_g = g + cost;
+                if(m_visited[next] == generation && m_g[next] <= next_g) {
+                    continue;
+                }
+                m_visited[next] = generation;
+                m_g[next]       = next_g;
+                m_parent[next]  = index;
+                // float rounding must not break the monotone heap
+                const uint32_t key = std::max(
+                    radix_heap_t<int>::float_key(
+                        next_g + heuristic(nx, ny, gx, gy)),
+                    m_open.last_key());
+                m_open.push(key, next);
+            }
+        }
+        return false;
+    }
+};
+
+}  // namespace radl
@@ -46,6 +46,12 @@ void gui_t::clear() {
     }
 }
 
+void gui_t::for_each_layer(const std::function<void(layer_t&)>& func) {
+    for(auto& [handle, layer] : gui_detail::render_order) {
+        func(*layer);
+    }
+}
+
 void gui_t::add_layer(const int handle, const int X, const int Y, const int W,
                       const int H, const std::string& font_name,
                       std::function<void(layer_t*, int, int)> resize_fun,
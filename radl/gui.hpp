@@ -56,6 +56,11 @@ public:
 
     void clear();
 
+    /**
+     * @brief Calls @p func for every layer, in render order.
+     */
+    void for_each_layer(const std::function<void(layer_t&)>& func);
+
     // Specialization for adding console layers
     void add_layer(int handle, int X, int Y, int W, int H,
                    const std::string& font_name,
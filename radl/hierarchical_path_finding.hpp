@@ -0,0 +1,572 @@
+/*
+ * Hierarchical path finding (HPA*) for long range travel on large grids.
+ *
+ * The map is cut into square clusters. Where two clusters touch, every run of
+ * cells walkable on both sides is an entrance, with one transition in its
+ * middle (or one at each end for wide entrances). The transition cells are
+ * the nodes of an abstract graph, linked across the borders and, inside each
+ * cluster, by the cost of the best path between them. A query searches that
+ * small graph, then each leg is refined with a local A* bounded to its
+ * cluster, lazily as the agent walks if wanted.
+ *
+ * When the walkability of a tile changes, call update_tile(): its cluster
+ * (and the neighbours whose entrances changed) are rebuilt before the next
+ * query, the rest of the graph is kept.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "path_finding.hpp"
+
+namespace radl {
+
+/*
+ * Result of hpa_search_t::find_route: the abstract path, to refine one leg at
+ * a time with hpa_search_t::refine_next.
+ */
+template <typename location_t>
+struct hpa_route_t {
+    bool success = false;
+    // start, the transition cells crossed and the destination
+    std::vector<location_t> waypoints;
+    // the next waypoint to refine towards
+    size_t next = 1;
+};
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class hpa_search_t {
+private:
+    static constexpr bool diagonal = grid_diagonal_moves<navigator_t>();
+    static constexpr float no_path = std::numeric_limits<float>::infinity();
+    // entrances this wide or wider get a transition at each end
+    static constexpr int wide_entrance = 6;
+
+    struct cluster_t {
+        grid_bounds_t bounds;
+        // abstract nodes: transition cells inside the cluster
+        std::vector<int> cells;
+        // per node, the cells across the border it leads to
+        std::vector<std::vector<int>> exits;
+        // costs[i * n + j]: best path from cells[i] to cells[j], inside
+        std::vector<float> costs;
+    };
+
+    using border_t = std::vector<std::pair<int, int>>;
+
+    int m_width        = 0;
+    int m_height       = 0;
+    int m_cluster_size = 0;
+    int m_columns      = 0;
+    int m_rows         = 0;
+    std::vector<cluster_t> m_clusters;
+    // transitions across the border right of and below each cluster, as
+    // (cell in the cluster, cell in the neighbour)
+    std::vector<border_t> m_right_borders;
+    std::vector<border_t> m_bottom_borders;
+    // clusters whose tiles changed since the last rebuild
+    std::vector<uint8_t> m_dirty;
+    bool m_any_dirty = false;
+
+    // abstract search, stamped like grid_search_t
+    std::vector<float> m_g;
+    std::vector<int> m_parent;
+    std::vector<uint32_t> m_visited;
+    std::vector<uint32_t> m_closed;
+    uint32_t m_generation = 0;
+    std::vector<std::pair<float, int>> m_open;
+    size_t m_expanded = 0;
+
+    // local searches
+    std::vector<float> m_local_costs;
+    std::vector<float> m_start_costs;
+    std::vector<float> m_goal_costs;
+    std::vector<std::pair<float, int>> m_local_open;
+    grid_search_t<location_t, navigator_t> m_local;
+    std::vector<location_t> m_segment;
+
+    static inline bool walkable(const int x, const int y) {
+        return navigator_t::is_walkable(navigator_t::get_xy(x, y));
+    }
+
+    // Cost of a single move onto x/y
+    static inline float step_cost(const int x, const int y,
+                                  const bool diagonal_move) {
+        float cost = diagonal_move ? grid_sqrt2 : 1.f;
+        if constexpr(weighted_grid_navigator<navigator_t, location_t>) {
+            cost *= static_cast<float>(
+                navigator_t::get_tile_cost(navigator_t::get_xy(x, y)));
+        }
+        return cost;
+    }
+
+    inline int cluster_of(const int cell) const noexcept {
+        return (cell / m_width / m_cluster_size) * m_columns
+               + (cell % m_width) / m_cluster_size;
+    }
+
+    // Smallest rectangle covering the clusters of two cells
+    inline grid_bounds_t cluster_bounds(const int a,
+                                        const int b) const noexcept {
+        const auto& first  = m_clusters[cluster_of(a)].bounds;
+        const auto& second = m_clusters[cluster_of(b)].bounds;
+        return grid_bounds_t{
+            std::min(first.x0, second.x0), std::min(first.y0, second.y0),
+            std::max(first.x1, second.x1), std::max(first.y1, second.y1)};
+    }
+
+    inline int local_index(const cluster_t& cluster,
+                           const int cell) const noexcept {
+        return (cell / m_width - cluster.bounds.y0) * m_cluster_size
+               + cell % m_width - cluster.bounds.x0;
+    }
+
+    /*
+     * Dijkstra from @p source inside @p cluster, into @p costs (one entry per
+     * cell of the cluster). Reversed, the costs are those of reaching
+     * @p source instead.
+     */
+    void local_dijkstra(const cluster_t& cluster, const int source,
+                        const bool reverse, std::vector<float>& costs) {
+        constexpr auto later = std::greater<std::pair<float, int>>();
+        costs.assign(static_cast<size_t>(m_cluster_size) * m_cluster_size,
+                     no_path);
+        costs[local_index(cluster, source)] = 0.f;
+        m_local_open.clear();
+        m_local_open.emplace_back(0.f, source);
+        while(!m_local_open.empty()) {
+            std::pop_heap(m_local_open.begin(), m_local_open.end(), later);
+            const auto [cost, cell] = m_local_open.back();
+            m_local_open.pop_back();
+            if(cost > costs[local_index(cluster, cell)]) {
+                continue;  // stale entry
+            }
+            const int x = cell % m_width;
+            const int y = cell / m_width;
+            for(int d = 0; d < (diagonal ? 8 : 4); ++d) {
+                const int nx = x + grid_dx[d];
+                const int ny = y + grid_dy[d];
+                if(!cluster.bounds.contains(nx, ny) || !walkable(nx, ny)) {
+                    continue;
+                }
+                // forward: moving onto the neighbour, reversed: moving from
+                // the neighbour onto this cell
+                const float next_cost
+                    = cost
+                      + (reverse ? step_cost(x, y, d >= 4)
+                                 : step_cost(nx, ny, d >= 4));
+                const int next = ny * m_width + nx;
+                float& best    = costs[local_index(cluster, next)];
+                if(next_cost < best) {
+                    best = next_cost;
+                    m_local_open.emplace_back(next_cost, next);
+                    std::push_heap(m_local_open.begin(), m_local_open.end(),
+                                   later);
+                }
+            }
+        }
+    }
+
+    // Entrances across the border right of (or below) cluster @p index
+    border_t find_transitions(const int index, const bool right) const {
+        border_t border;
+        const auto& bounds = m_clusters[index].bounds;
+        const int length   = right ? bounds.y1 - bounds.y0
+                                   : bounds.x1 - bounds.x0;
+        const auto cells   = [&](const int i) {
+            const int x = right ? bounds.x1 - 1 : bounds.x0 + i;
+            const int y = right ? bounds.y0 + i : bounds.y1 - 1;
+            return std::pair<int, int>{
+                y * m_width + x,
+                (right ? y : y + 1) * m_width + (right ? x + 1 : x)};
+        };
+        const auto open = [&](const int i) {
+            const auto [inside, outside] = cells(i);
+            return walkable(inside % m_width, inside / m_width)
+                   && walkable(outside % m_width, outside / m_width);
+        };
+        for(int i = 0; i < length;) {
+            if(!open(i)) {
+                ++i;
+                continue;
+            }
+            int end = i;
+            while(end < length && open(end)) {
+                ++end;
+            }
+            if(end - i >= wide_entrance) {
+                border.push_back(cells(i));
+                border.push_back(cells(end - 1));
+            } else {
+                border.push_back(cells((i + end - 1) / 2));
+            }
+            i = end;
+        }
+        return border;
+    }
+
+    void add_node(cluster_t& cluster, const int cell, const int exit) {
+        const auto finder
+            = std::find(cluster.cells.begin(), cluster.cells.end(), cell);
+        if(finder != cluster.cells.end()) {
+            cluster.exits[finder - cluster.cells.begin()].push_back(exit);
+            return;
+        }
+        cluster.cells.push_back(cell);
+        cluster.exits.push_back({exit});
+    }
+
+    // Gathers the nodes of cluster @p index from its borders and computes
+    // the costs between them
+    void build_cluster(const int index) {
+        auto& cluster = m_clusters[index];
+        cluster.cells.clear();
+        cluster.exits.clear();
+        const int column = index % m_columns;
+        const int row    = index / m_columns;
+        for(const auto& [inside, outside] : m_right_borders[index]) {
+            add_node(cluster, inside, outside);
+        }
+        for(const auto& [inside, outside] : m_bottom_borders[index]) {
+            add_node(cluster, inside, outside);
+        }
+        if(column > 0) {
+            for(const auto& [outside, inside] : m_right_borders[index - 1]) {
+                add_node(cluster, inside, outside);
+            }
+        }
+        if(row > 0) {
+            for(const auto& [outside, inside] :
+                m_bottom_borders[index - m_columns]) {
+                add_node(cluster, inside, outside);
+            }
+        }
+
+        const size_t n = cluster.cells.size();
+        cluster.costs.assign(n * n, no_path);
+        for(size_t i = 0; i < n; ++i) {
+            local_dijkstra(cluster, cluster.cells[i], false, m_local_costs);
+            for(size_t j = 0; j < n; ++j) {
+                cluster.costs[i * n + j]
+                    = m_local_costs[local_index(cluster, cluster.cells[j])];
+            }
+        }
+    }
+
+    // Rebuilds what the tile changes since the last query touched
+    void rebuild() {
+        if(!m_any_dirty) {
+            return;
+        }
+        std::vector<uint8_t> rebuild_cluster = m_dirty;
+        const auto update_border = [&](std::vector<border_t>& borders,
+                                       const int index, const bool right,
+                                       const int neighbour) {
+            auto border = find_transitions(index, right);
+            if(border != borders[index]) {
+                borders[index]             = std::move(border);
+                rebuild_cluster[index]     = 1;
+                rebuild_cluster[neighbour] = 1;
+            }
+        };
+        for(int index = 0; index < static_cast<int>(m_dirty.size());
+            ++index) {
+            if(!m_dirty[index]) {
+                continue;
+            }
+            const int column = index % m_columns;
+            const int row    = index / m_columns;
+            if(column + 1 < m_columns) {
+                update_border(m_right_borders, index, true, index + 1);
+            }
+            if(column > 0) {
+                update_border(m_right_borders, index - 1, true, index - 1);
+            }
+            if(row + 1 < m_rows) {
+                update_border(m_bottom_borders, index, false,
+                              index + m_columns);
+            }
+            if(row > 0) {
+                update_border(m_bottom_borders, index - m_columns, false,
+                              index - m_columns);
+            }
+        }
+        for(int index = 0; index < static_cast<int>(m_dirty.size());
+            ++index) {
+            if(rebuild_cluster[index]) {
+                build_cluster(index);
+            }
+        }
+        std::fill(m_dirty.begin(), m_dirty.end(), 0);
+        m_any_dirty = false;
+    }
+
+    inline void open_node(const int cell, const float g, const int parent,
+                          const int goal) {
+        if(m_closed[cell] == m_generation
+           || (m_visited[cell] == m_generation && m_g[cell] <= g)) {
+            return;
+        }
+        m_visited[cell] = m_generation;
+        m_g[cell]       = g;
+        m_parent[cell]  = parent;
+        const float f
+            = g
+              + grid_distance<diagonal>(cell % m_width - goal % m_width,
+                                        cell / m_width - goal / m_width);
+        m_open.emplace_back(f, cell);
+        std::push_heap(m_open.begin(), m_open.end(),
+                       std::greater<std::pair<float, int>>());
+    }
+
+public:
+    /**
+     * @param cluster_size width and height of a cluster in cells, larger
+     * clusters make the abstract graph smaller but the local searches longer
+     */
+    hpa_search_t(const int width, const int height,
+                 const int cluster_size = 16)
+        : m_local(width, height) {
+        resize(width, height, cluster_size);
+    }
+
+    /**
+     * @brief Sets the size of the map, the whole graph is rebuilt on the next
+     * query.
+     */
+    void resize(const int width, const int height, const int cluster_size) {
+        m_width        = width;
+        m_height       = height;
+        m_cluster_size = cluster_size;
+        m_columns      = (width + cluster_size - 1) / cluster_size;
+        m_rows         = (height + cluster_size - 1) / cluster_size;
+        const size_t count = static_cast<size_t>(m_columns) * m_rows;
+        m_clusters.assign(count, cluster_t{});
+        for(int row = 0; row < m_rows; ++row) {
+            for(int column = 0; column < m_columns; ++column) {
+                m_clusters[row * m_columns + column].bounds = grid_bounds_t{
+                    column * cluster_size,
+                    row * cluster_size,
+                    std::min(width, (column + 1) * cluster_size),
+                    std::min(height, (row + 1) * cluster_size),
+                };
+            }
+        }
+        m_right_borders.assign(count, border_t{});
+        m_bottom_borders.assign(count, border_t{});
+        m_dirty.assign(count, 1);
+        m_any_dirty = true;
+
+        const size_t n = static_cast<size_t>(width) * height;
+        m_g.assign(n, 0.f);
+        m_parent.assign(n, -1);
+        m_visited.assign(n, 0);
+        m_closed.assign(n, 0);
+        m_generation = 0;
+        m_local.resize(width, height);
+    }
+
+    /**
+     * @brief Tells the graph that the walkability (or cost) of x/y changed.
+     * The affected clusters are rebuilt by the next query. Off-map tiles are
+     * ignored.
+     */
+    void update_tile(const int x, const int y) {
+        if(x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return;
+        }
+        m_dirty[(y / m_cluster_size) * m_columns + x / m_cluster_size] = 1;
+        m_any_dirty = true;
+    }
+
+    /**
+     * @brief Number of abstract nodes expanded by the last route search.
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief Searches the abstract graph from @p start to @p end. Nothing is
+     * refined yet, see refine_next.
+     */
+    hpa_route_t<location_t> find_route(const location_t& start,
+                                       const location_t& end) {
+        rebuild();
+        hpa_route_t<location_t> route;
+        m_expanded   = 0;
+        const int sx = navigator_t::get_x(start);
+        const int sy = navigator_t::get_y(start);
+        const int gx = navigator_t::get_x(end);
+        const int gy = navigator_t::get_y(end);
+        const grid_bounds_t map{0, 0, m_width, m_height};
+        if(!map.contains(sx, sy) || !map.contains(gx, gy)
+           || !walkable(sx, sy) || !walkable(gx, gy)) {
+            return route;
+        }
+        const int first = sy * m_width + sx;
+        const int goal  = gy * m_width + gx;
+
+        // the start and goal join the graph through their clusters
+        const auto& start_cluster = m_clusters[cluster_of(first)];
+        const auto& goal_cluster  = m_clusters[cluster_of(goal)];
+        local_dijkstra(start_cluster, first, false, m_start_costs);
+        local_dijkstra(goal_cluster, goal, true, m_goal_costs);
+
+        if(++m_generation == 0) {
+            std::fill(m_visited.begin(), m_visited.end(), 0);
+            std::fill(m_closed.begin(), m_closed.end(), 0);
+            m_generation = 1;
+        }
+        m_open.clear();
+        open_node(first, 0.f, -1, goal);
+        while(!m_open.empty()) {
+            std::pop_heap(m_open.begin(), m_open.end(),
+                          std::greater<std::pair<float, int>>());
+            const int cell = m_open.back().second;
+            m_open.pop_back();
+            if(m_closed[cell] == m_generation) {
+                continue;
+            }
+            m_closed[cell] = m_generation;
+            if(cell == goal) {
+                for(int node = goal; node != -1; node = m_parent[node]) {
+                    route.waypoints.push_back(navigator_t::get_xy(
+                        node % m_width, node / m_width));
+                }
+                std::reverse(route.waypoints.begin(), route.waypoints.end());
+                route.success = true;
+                break;
+            }
+            ++m_expanded;
+
+            const float g       = m_g[cell];
+            const auto& cluster = m_clusters[cluster_of(cell)];
+            const size_t n      = cluster.cells.size();
+            if(cell == first) {
+                for(size_t j = 0; j < n; ++j) {
+                    const int index = local_index(cluster, cluster.cells[j]);
+                    const float cost = m_start_costs[index];
+                    if(cost != no_path) {
+                        open_node(cluster.cells[j], g + cost, cell, goal);
+                    }
+                }
+            }
+            if(&cluster == &goal_cluster) {
+                const float cost = m_goal_costs[local_index(cluster, cell)];
+                if(cost != no_path) {
+                    open_node(goal, g + cost, cell, goal);
+                }
+            }
+            const auto node
+                = std::find(cluster.cells.begin(), cluster.cells.end(), cell);
+            if(node == cluster.cells.end()) {
+                continue;
+            }
+            const size_t i = node - cluster.cells.begin();
+            for(size_t j = 0; j < n; ++j) {
+                const float cost = cluster.costs[i * n + j];
+                if(j != i && cost != no_path) {
+                    open_node(cluster.cells[j], g + cost, cell, goal);
+                }
+            }
+            for(const int exit : cluster.exits[i]) {
+                open_node(exit,
+                          g + step_cost(exit % m_width, exit / m_width, false),
+                          cell, goal);
+            }
+        }
+
+        // Nearby goals: the transitions can be a detour, a direct search
+        // over both clusters may be cheaper
+        const grid_bounds_t around = cluster_bounds(first, goal);
+        if(around.x1 - around.x0 <= 2 * m_cluster_size
+           && around.y1 - around.y0 <= 2 * m_cluster_size
+           && m_local.find_within(around, start, end, m_segment)) {
+            float cost = 0.f;
+            for(size_t i = 1; i < m_segment.size(); ++i) {
+                const int x = navigator_t::get_x(m_segment[i]);
+                const int y = navigator_t::get_y(m_segment[i]);
+                cost += step_cost(x, y,
+                                  x != navigator_t::get_x(m_segment[i - 1])
+                                      && y != navigator_t::get_y(
+                                             m_segment[i - 1]));
+            }
+            if(!route.success || cost < m_g[goal]) {
+                route.waypoints = {start, end};
+                route.success   = true;
+            }
+        }
+        return route;
+    }
+
+    /**
+     * @brief Refines the next leg of @p route, appending its cells (not the
+     * one already reached) to @p steps.
+     *
+     * @return false when the route is complete, or the leg can no longer be
+     * walked (the map changed, search again)
+     */
+    bool refine_next(hpa_route_t<location_t>& route,
+                     std::deque<location_t>& steps) {
+        if(!route.success || route.next >= route.waypoints.size()) {
+            return false;
+        }
+        const auto& from = route.waypoints[route.next - 1];
+        const auto& to   = route.waypoints[route.next];
+        const int from_cell
+            = navigator_t::get_y(from) * m_width + navigator_t::get_x(from);
+        const int to_cell
+            = navigator_t::get_y(to) * m_width + navigator_t::get_x(to);
+        const int dx = std::abs(from_cell % m_width - to_cell % m_width);
+        const int dy = std::abs(from_cell / m_width - to_cell / m_width);
+        if(cluster_of(from_cell) != cluster_of(to_cell) && dx <= 1 && dy <= 1
+           && (diagonal || dx + dy == 1)) {
+            // crossing a border
+            steps.push_back(to);
+        } else {
+            if(!m_local.find_within(cluster_bounds(from_cell, to_cell), from,
+                                    to, m_segment)) {
+                return false;
+            }
+            steps.insert(steps.end(), m_segment.begin() + 1, m_segment.end());
+        }
+        ++route.next;
+        return true;
+    }
+
+    /**
+     * @brief Finds a path and refines it completely, like path_find but with
+     * no step limit.
+     */
+    astar_path_t<location_t> find(const location_t& start,
+                                  const location_t& end) {
+        auto result = astar_path_t<location_t>{false, end};
+        auto route  = find_route(start, end);
+        if(!route.success) {
+            return result;
+        }
+        result.steps.push_back(start);
+        while(route.next < route.waypoints.size()) {
+            if(!refine_next(route, result.steps)) {
+                result.steps.clear();
+                return result;
+            }
+        }
+        result.success = true;
+        return result;
+    }
+};
+
+}  // namespace radl
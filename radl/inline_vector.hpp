@@ -0,0 +1,98 @@
+/*
+ * Vector with a fixed capacity and its elements stored inline, so it lives on
+ * the stack and never allocates. Navigators fill one with the successors of a
+ * location, which never number more than a handful.
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace radl {
+
+template <typename T, size_t capacity_v>
+class inline_vector_t {
+private:
+    std::array<T, capacity_v> m_items{};
+    size_t m_size = 0;
+
+public:
+    using value_type     = T;
+    using iterator       = T*;
+    using const_iterator = const T*;
+
+    static constexpr size_t capacity() noexcept {
+        return capacity_v;
+    }
+
+    inline size_t size() const noexcept {
+        return m_size;
+    }
+
+    inline bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    inline bool full() const noexcept {
+        return m_size == capacity_v;
+    }
+
+    /**
+     * @brief Appends @p item. Throws if the vector is full: for a successor
+     * buffer, the navigator gives more successors than its max_successors.
+     */
+    inline void push_back(const T& item) {
+        if(full()) {
+            throw std::runtime_error("inline_vector_t capacity exceeded");
+        }
+        m_items[m_size++] = item;
+    }
+
+    template <typename... args_t>
+    inline void emplace_back(args_t&&... args) {
+        push_back(T(std::forward<args_t>(args)...));
+    }
+
+    inline void pop_back() noexcept {
+        assert(m_size > 0);
+        --m_size;
+    }
+
+    inline void clear() noexcept {
+        m_size = 0;
+    }
+
+    inline T& operator[](const size_t index) noexcept {
+        return m_items[index];
+    }
+
+    inline const T& operator[](const size_t index) const noexcept {
+        return m_items[index];
+    }
+
+    inline T* data() noexcept {
+        return m_items.data();
+    }
+
+    inline iterator begin() noexcept {
+        return m_items.data();
+    }
+
+    inline iterator end() noexcept {
+        return m_items.data() + m_size;
+    }
+
+    inline const_iterator begin() const noexcept {
+        return m_items.data();
+    }
+
+    inline const_iterator end() const noexcept {
+        return m_items.data() + m_size;
+    }
+};
+
+}  // namespace radl
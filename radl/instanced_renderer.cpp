@@ -0,0 +1,216 @@
+#include "instanced_renderer.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+
+#include "raymath.h"
+#include "rlgl.h"
+#include "texture_resources.hpp"
+
+namespace radl {
+
+namespace {
+
+// Unit cell as two triangles, same winding raylib uses for its quads
+constexpr float quad_corners[] = {
+    0.f, 0.f, 0.f, 1.f, 1.f, 1.f,  // first triangle
+    0.f, 0.f, 1.f, 1.f, 1.f, 0.f,  // second triangle
+};
+
+enum instanced_location_t {
+    L_CORNER = 0,
+    L_GLYPH,
+    L_FOREGROUND,
+    L_BACKGROUND,
+};
+
+}  // namespace
+
+instanced_renderer::~instanced_renderer() {
+    unload();
+}
+
+void instanced_renderer::unload() {
+    if(m_vao != 0) {
+        rlUnloadVertexArray(m_vao);
+        rlUnloadVertexBuffer(m_quad_vbo);
+        rlUnloadVertexBuffer(m_instance_vbo);
+    }
+    m_vao          = 0;
+    m_quad_vbo     = 0;
+    m_instance_vbo = 0;
+}
+
+void instanced_renderer::resize(const int columns, const int rows) {
+    unload();
+    m_columns = columns;
+    m_rows    = rows;
+    m_instances.resize(static_cast<size_t>(columns) * rows);
+    m_uploaded.resize(m_instances.size());
+    m_stale = true;
+
+    m_shader   = get_shader("terminal_instanced");
+    m_uniforms = uniforms_t{
+        GetShaderLocation(m_shader, "mvp"),
+        GetShaderLocation(m_shader, "cellSize"),
+        GetShaderLocation(m_shader, "atlasSize"),
+        GetShaderLocation(m_shader, "columns"),
+        GetShaderLocation(m_shader, "rows"),
+        GetShaderLocation(m_shader, "texture0"),
+        GetShaderLocation(m_shader, "pass"),
+    };
+
+    constexpr int stride = sizeof(cell_instance_t);
+    m_vao                = rlLoadVertexArray();
+    rlEnableVertexArray(m_vao);
+
+    m_quad_vbo = rlLoadVertexBuffer(quad_corners, sizeof(quad_corners), false);
+    rlSetVertexAttribute(L_CORNER, 2, RL_FLOAT, false, 0, 0);
+    rlEnableVertexAttribute(L_CORNER);
+
+    m_instance_vbo = rlLoadVertexBuffer(
+        nullptr, static_cast<int>(m_instances.size()) * stride, true);
+    rlSetVertexAttribute(L_GLYPH, 2, RL_FLOAT, false, stride,
+                         offsetof(cell_instance_t, glyph_x));
+    rlSetVertexAttribute(L_FOREGROUND, 4, RL_UNSIGNED_BYTE, true, stride,
+                         offsetof(cell_instance_t, foreground));
+    rlSetVertexAttribute(L_BACKGROUND, 4, RL_UNSIGNED_BYTE, true, stride,
+                         offsetof(cell_instance_t, background));
+    for(const auto location : {L_GLYPH, L_FOREGROUND, L_BACKGROUND}) {
+        rlSetVertexAttributeDivisor(location, 1);
+        rlEnableVertexAttribute(location);
+    }
+
+    rlDisableVertexBuffer();
+    rlDisableVertexArray();
+}
+
+void instanced_renderer::upload(const bitmap_font& font,
+                                const cell_buffer_t& cells) {
+    if(&font != m_uploaded_font) {
+        m_uploaded_font = &font;
+        m_stale         = true;
+    }
+    const palette_t* palette = cells.palette();
+    if((palette == nullptr) != (m_uploaded.palette() == nullptr)) {
+        // only the mode of m_uploaded matters, its cells stay packed
+        m_uploaded.set_palette(palette);
+        m_stale = true;
+    }
+    if(palette) {
+        // a recolor keeps the cells, but the instances hold resolved colors
+        const color_t* colors = palette->data();
+        if(!std::equal(colors, colors + palette->size(),
+                       m_uploaded_palette.begin(), m_uploaded_palette.end())) {
+            m_uploaded_palette.assign(colors, colors + palette->size());
+            m_stale = true;
+        }
+    }
+
+    Rectangle glyph_rect{};
+    auto rebuild = [&](const size_t index) {
+        const auto vch = cells.get(index);
+        set_rectangle_position_from_vchar(glyph_rect, vch, font);
+        m_instances[index] = cell_instance_t{
+            glyph_rect.x,
+            glyph_rect.y,
+            vch.foreground,
+            vch.background,
+        };
+        m_uploaded.copy(index, cells);
+    };
+
+    // The range of instances to upload
+    size_t first = cells.size();
+    size_t last  = 0;
+    if(m_stale) {
+        m_stale = false;
+        for(size_t i = 0; i < cells.size(); ++i) {
+            rebuild(i);
+        }
+        first = 0;
+        last  = cells.size();
+    } else {
+        for(size_t chunk = 0; chunk < cells.size();
+            chunk += cell_buffer_t::chunk_size) {
+            const int count = static_cast<int>(std::min<size_t>(
+                cell_buffer_t::chunk_size, cells.size() - chunk));
+            for(uint32_t changed = cells.diff(m_uploaded, chunk, count);
+                changed != 0; changed &= changed - 1) {
+                const size_t index = chunk + std::countr_zero(changed);
+                rebuild(index);
+                first = std::min(first, index);
+                last  = index + 1;
+            }
+        }
+    }
+    if(first < last) {
+        constexpr size_t stride = sizeof(cell_instance_t);
+        rlUpdateVertexBuffer(m_instance_vbo, m_instances.data() + first,
+                             static_cast<int>((last - first) * stride),
+                             static_cast<int>(first * stride));
+    }
+}
+
+void instanced_renderer::render(RenderTexture2D& target,
+                                const bitmap_font& font,
+                                const cell_buffer_t& cells,
+                                const bool has_background) {
+    if(m_instances.size() != cells.size()) {
+        throw std::runtime_error("Instanced renderer not sized to terminal");
+    }
+
+    upload(font, cells);
+
+    const auto atlas = get_texture(font.texture_tag);
+    const Vector2 cell_size{
+        static_cast<float>(font.character_size.first),
+        static_cast<float>(font.character_size.second),
+    };
+    const Vector2 atlas_size{
+        static_cast<float>(atlas.width),
+        static_cast<float>(atlas.height),
+    };
+    const int sampler = 0;
+    const auto instances = static_cast<int>(m_instances.size());
+
+    BeginTextureMode(target);
+    ClearBackground(BLANK);
+    // BeginTextureMode flushes raylib's batch and loads the texture projection
+    const Matrix mvp
+        = MatrixMultiply(rlGetMatrixModelview(), rlGetMatrixProjection());
+
+    rlEnableShader(m_shader.id);
+    rlSetUniformMatrix(m_uniforms.mvp, mvp);
+    SetShaderValue(m_shader, m_uniforms.cell_size, &cell_size,
+                   SHADER_UNIFORM_VEC2);
+    SetShaderValue(m_shader, m_uniforms.atlas_size, &atlas_size,
+                   SHADER_UNIFORM_VEC2);
+    SetShaderValue(m_shader, m_uniforms.columns, &m_columns,
+                   SHADER_UNIFORM_INT);
+    SetShaderValue(m_shader, m_uniforms.rows, &m_rows, SHADER_UNIFORM_INT);
+    SetShaderValue(m_shader, m_uniforms.texture0, &sampler,
+                   SHADER_UNIFORM_INT);
+
+    rlActiveTextureSlot(0);
+    rlEnableTexture(atlas.id);
+    rlEnableVertexArray(m_vao);
+    rlSetBlendMode(BLEND_ALPHA);
+
+    if(has_background) {
+        const int pass = 0;
+        SetShaderValue(m_shader, m_uniforms.pass, &pass, SHADER_UNIFORM_INT);
+        rlDrawVertexArrayInstanced(0, 6, instances);
+    }
+    const int pass = 1;
+    SetShaderValue(m_shader, m_uniforms.pass, &pass, SHADER_UNIFORM_INT);
+    rlDrawVertexArrayInstanced(0, 6, instances);
+
+    rlDisableVertexArray();
+    rlDisableTexture();
+    rlDisableShader();
+    EndTextureMode();
+}
+
+}  // namespace radl
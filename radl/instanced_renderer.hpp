@@ -0,0 +1,77 @@
+/*
+ * Instanced renderer for virtual terminals: the whole cell buffer is uploaded
+ * into a single instance buffer and each pass (background, glyphs) is a single
+ * instanced draw call.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "cell_renderer.hpp"
+
+namespace radl {
+
+class instanced_renderer final : public cell_renderer {
+private:
+    // Per-cell data as seen by the vertex shader
+    struct cell_instance_t {
+        float glyph_x;
+        float glyph_y;
+        color_t foreground;
+        color_t background;
+    };
+
+    // Uniform locations of the terminal_instanced shader
+    struct uniforms_t {
+        int mvp        = -1;
+        int cell_size  = -1;
+        int atlas_size = -1;
+        int columns    = -1;
+        int rows       = -1;
+        int texture0   = -1;
+        int pass       = -1;
+    };
+
+    unsigned int m_vao          = 0;
+    unsigned int m_quad_vbo     = 0;
+    unsigned int m_instance_vbo = 0;
+    int m_columns               = 0;
+    int m_rows                  = 0;
+    Shader m_shader{};
+    uniforms_t m_uniforms;
+    std::vector<cell_instance_t> m_instances;
+    // What the instance buffer holds: the cells, font and palette colors of
+    // the last upload. Only the instances of changed cells are rebuilt, all
+    // of them when the font or palette changed.
+    cell_buffer_t m_uploaded;
+    const bitmap_font* m_uploaded_font = nullptr;
+    std::vector<color_t> m_uploaded_palette;
+    bool m_stale                       = true;
+
+    void unload();
+
+    // Brings the instance buffer up to date with @p cells
+    void upload(const bitmap_font& font, const cell_buffer_t& cells);
+
+public:
+    instanced_renderer() = default;
+
+    instanced_renderer(const instanced_renderer&)            = delete;
+    instanced_renderer& operator=(const instanced_renderer&) = delete;
+
+    ~instanced_renderer() override;
+
+    void resize(int columns, int rows) override;
+
+    /**
+     * @brief Redraws every cell of @p cells into @p target, one draw call for
+     * the backgrounds (if @p has_background) and one for the glyphs. Only the
+     * instances of the cells changed since the last render are uploaded.
+     */
+    void render(RenderTexture2D& target, const bitmap_font& font,
+                const cell_buffer_t& cells, bool has_background) override;
+};
+
+}  // namespace radl
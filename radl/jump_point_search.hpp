@@ -0,0 +1,384 @@
+/*
+ * Jump Point Search for uniform cost, 8-connected grids: the symmetric paths
+ * are pruned and only jump points are put on the open list, so a search
+ * expands orders of magnitude fewer cells than A*. Moves cost 1 and
+ * diagonals sqrt(2), diagonals may cut corners (as with grid_search_t).
+ *
+ * The navigator is a grid_navigator (see grid_path_finding.hpp). After
+ * precompute() the walkability is read from a bitmap snapshot and the jump
+ * distances of every cell come from tables (JPS+): call it again whenever
+ * the map changes, or clear_precomputed() to go back to online jumps.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+#include "path_finding.hpp"
+#include "radix_heap.hpp"
+
+namespace radl {
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class jps_search_t {
+    static_assert(grid_diagonal_moves<navigator_t>(),
+                  "Jump Point Search needs diagonal moves");
+    static_assert(!weighted_grid_navigator<navigator_t, location_t>,
+                  "Jump Point Search needs uniform tile costs");
+
+private:
+    int m_width  = 0;
+    int m_height = 0;
+    // cost from the start and parent jump point, valid where m_visited is the
+    // current generation
+    std::vector<float> m_g;
+    std::vector<int> m_parent;
+    std::vector<uint32_t> m_visited;
+    std::vector<uint32_t> m_closed;
+    uint32_t m_generation = 0;
+    radix_heap_t<int> m_open;
+    size_t m_expanded = 0;
+
+    // JPS+: walkability snapshot and, per direction and cell, the distance to
+    // the next jump point (> 0) or minus the walkable steps before a wall
+    bool m_precomputed = false;
+    std::vector<uint8_t> m_walkable;
+    std::array<std::vector<int>, 8> m_jumps;
+
+    static inline int direction_index(const int dx, const int dy) noexcept {
+        for(int d = 0; d < 8; ++d) {
+            if(grid_dx[d] == dx && grid_dy[d] == dy) {
+                return d;
+            }
+        }
+        return -1;
+    }
+
+    static inline int sign(const int value) noexcept {
+        return (value > 0) - (value < 0);
+    }
+
+    inline bool walkable(const int x, const int y) const {
+        if(x < 0 || y < 0 || x >= m_width || y >= m_height) {
+            return false;
+        }
+        if(m_precomputed) {
+            return m_walkable[y * m_width + x] != 0;
+        }
+        return navigator_t::is_walkable(navigator_t::get_xy(x, y));
+    }
+
+    // Has (x, y) a forced neighbour when entered moving by dx/dy
+    inline bool forced(const int x, const int y, const int dx,
+                       const int dy) const {
+        if(dx != 0 && dy != 0) {
+            return (!walkable(x - dx, y) && walkable(x - dx, y + dy))
+                   || (!walkable(x, y - dy) && walkable(x + dx, y - dy));
+        }
+        if(dx != 0) {
+            return (!walkable(x, y + 1) && walkable(x + dx, y + 1))
+                   || (!walkable(x, y - 1) && walkable(x + dx, y - 1));
+        }
+        return (!walkable(x + 1, y) && walkable(x + 1, y + dy))
+               || (!walkable(x - 1, y) && walkable(x - 1, y + dy));
+    }
+
+    // Online jump from (x, y) by dx/dy: the next jump point (or the goal),
+    // -1 when a wall comes first
+    int jump(int x, int y, const int dx, const int dy, const int goal) const {
+        for(;;) {
+            x += dx;
+            y += dy;
+            if(!walkable(x, y)) {
+                return -1;
+            }
+            const int index = y * m_width + x;
+            if(index == goal || forced(x, y, dx, dy)) {
+                return index;
+            }
+            if(dx != 0 && dy != 0
+               && (jump(x, y, dx, 0, goal) >= 0
+                   || jump(x, y, 0, dy, goal) >= 0)) {
+                return index;
+            }
+        }
+    }
+
+    // JPS+ jump: the successor in direction d, the goal when it is in reach,
+    // -1 if there is none
+    int jump_table(const int x, const int y, const int d, const int gx,
+                   const int gy) const {
+        const int dx       = grid_dx[d];
+        const int dy       = grid_dy[d];
+        const int distance = m_jumps[d][y * m_width + x];
+        const int reach    = std::abs(distance);
+        const int to_gx    = gx - x;
+        const int to_gy    = gy - y;
+        int steps          = distance > 0 ? distance : -1;
+        if(dx == 0 || dy == 0) {
+            // the goal straight ahead, before the next jump point or wall
+            const int along = dx != 0 ? to_gx * dx : to_gy * dy;
+            const int side  = dx != 0 ? to_gy : to_gx;
+            if(side == 0 && along > 0 && along <= reach) {
+                steps = along;
+            }
+        } else if(sign(to_gx) == dx && sign(to_gy) == dy) {
+            // the goal in this quadrant: stop on its row or column, a
+            // straight jump goes on from there
+            const int aligned = std::min(std::abs(to_gx), std::abs(to_gy));
+            if(aligned <= reach) {
+                steps = aligned;
+            }
+        }
+        if(steps < 0) {
+            return -1;
+        }
+        return (y + dy * steps) * m_width + x + dx * steps;
+    }
+
+    void next_generation() {
+        if(++m_generation == 0) {
+            std::fill(m_visited.begin(), m_visited.end(), 0);
+            std::fill(m_closed.begin(), m_closed.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    // Every cell between consecutive jump points, start included
+    void unpack_path(const int goal, std::deque<location_t>& steps) const {
+        for(int cell = goal; m_parent[cell] != -1; cell = m_parent[cell]) {
+            const int parent = m_parent[cell];
+            int x            = cell % m_width;
+            int y            = cell / m_width;
+            const int dx     = sign(parent % m_width - x);
+            const int dy     = sign(parent / m_width - y);
+            for(; y * m_width + x != parent; x += dx, y += dy) {
+                steps.push_front(navigator_t::get_xy(x, y));
+            }
+        }
+    }
+
+public:
+    jps_search_t(const int width, const int height) {
+        resize(width, height);
+    }
+
+    /**
+     * @brief Sets the size of the map, drops the JPS+ tables.
+     */
+    void resize(const int width, const int height) {
+        m_width        = width;
+        m_height       = height;
+        const size_t n = static_cast<size_t>(width) * height;
+        m_g.assign(n, 0.f);
+        m_parent.assign(n, -1);
+        m_visited.assign(n, 0);
+        m_closed.assign(n, 0);
+        m_generation = 0;
+        clear_precomputed();
+    }
+
+    /**
+     * @brief JPS+: snapshots the walkability of the map and precomputes the
+     * jump distances of every cell. Redo it whenever the map changes.
+     */
+    void precompute() {
+        m_precomputed = false;
+        const size_t n = static_cast<size_t>(m_width) * m_height;
+        m_walkable.resize(n);
+        for(int y = 0; y < m_height; ++y) {
+            for(int x = 0; x < m_width; ++x) {
+                m_walkable[y * m_width + x] = walkable(x, y) ? 1 : 0;
+            }
+        }
+        m_precomputed = true;
+
+        // straight directions first, the diagonal jumps depend on them
+        for(int d = 0; d < 8; ++d) {
+            const int dx = grid_dx[d];
+            const int dy = grid_dy[d];
+            auto& jumps  = m_jumps[d];
+            jumps.assign(n, 0);
+            // visit every cell after the one it leads to
+            const int x0 = dx > 0 ? m_width - 1 : 0;
+            const int y0 = dy > 0 ? m_height - 1 : 0;
+            const int xs = dx > 0 ? -1 : 1;
+            const int ys = dy > 0 ? -1 : 1;
+            for(int j = 0, y = y0; j < m_height; ++j, y += ys) {
+                for(int i = 0, x = x0; i < m_width; ++i, x += xs) {
+                    const int nx = x + dx;
+                    const int ny = y + dy;
+                    if(!walkable(x, y) || !walkable(nx, ny)) {
+                        continue;  // 0: wall next
+                    }
+                    const int next = ny * m_width + nx;
+                    bool is_jump   = forced(nx, ny, dx, dy);
+                    if(d >= 4) {
+                        is_jump = is_jump
+                                  || m_jumps[direction_index(dx, 0)][next] > 0
+                                  || m_jumps[direction_index(0, dy)][next] > 0;
+                    }
+                    const int after = jumps[next];
+                    jumps[y * m_width + x]
+                        = is_jump ? 1 : (after > 0 ? after + 1 : after - 1);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Back to online jumps, reading the navigator directly.
+     */
+    void clear_precomputed() {
+        m_precomputed = false;
+        m_walkable.clear();
+        for(auto& jumps : m_jumps) {
+            jumps.clear();
+        }
+    }
+
+    inline bool is_precomputed() const noexcept {
+        return m_precomputed;
+    }
+
+    /**
+     * @brief Number of jump points expanded by the last search.
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief Finds a shortest path from @p start to @p end, like path_find.
+     *
+     * @param limit_steps give up after expanding this many jump points
+     * @return the path, every cell from start to end
+     */
+    astar_path_t<location_t>
+    find(const location_t& start, const location_t& end,
+         const size_t limit_steps = std::numeric_limits<size_t>::max()) {
+        auto result  = astar_path_t<location_t>{false, end};
+        m_expanded   = 0;
+        const int sx = navigator_t::get_x(start);
+        const int sy = navigator_t::get_y(start);
+        const int gx = navigator_t::get_x(end);
+        const int gy = navigator_t::get_y(end);
+        if(!walkable(sx, sy) || !walkable(gx, gy)) {
+            return result;
+        }
+
+        next_generation();
+        const uint32_t generation = m_generation;
+        const int goal            = gy * m_width + gx;
+        const int first           = sy * m_width + sx;
+        m_open.clear();
+        m_g[first]       = 0.f;
+        m_parent[first]  = -1;
+        m_visited[first] = generation;
+        m_open.push(
+            radix_heap_t<int>::float_key(grid_distance<true>(gx - sx, gy - sy)),
+            first);
+
+        while(!m_open.empty()) {
+            const int index = m_open.pop().second;
+            if(m_closed[index] == generation) {
+                continue;  // stale entry
+            }
+            m_closed[index] = generation;
+            if(index == goal) {
+                unpack_path(goal, result.steps);
+                result.steps.push_front(start);
+                result.success = true;
+                return result;
+            }
+            if(++m_expanded > limit_steps) {
+                return result;
+            }
+
+            const int x = index % m_width;
+            const int y = index / m_width;
+            // pruning: the natural and forced neighbours for the direction
+            // the cell was entered from, all of them for the start
+            int px = 0;
+            int py = 0;
+            if(m_parent[index] != -1) {
+                px = sign(x - m_parent[index] % m_width);
+                py = sign(y - m_parent[index] / m_width);
+            }
+            std::array<int, 8> directions;
+            int count       = 0;
+            const auto keep = [&](const int dx, const int dy) {
+                if(walkable(x + dx, y + dy)) {
+                    directions[count++] = direction_index(dx, dy);
+                }
+            };
+            if(px == 0 && py == 0) {
+                for(int d = 0; d < 8; ++d) {
+                    keep(grid_dx[d], grid_dy[d]);
+                }
+            } else if(px != 0 && py != 0) {
+                keep(px, 0);
+                keep(0, py);
+                keep(px, py);
+                if(!walkable(x - px, y)) {
+                    keep(-px, py);
+                }
+                if(!walkable(x, y - py)) {
+                    keep(px, -py);
+                }
+            } else if(px != 0) {
+                keep(px, 0);
+                if(!walkable(x, y + 1)) {
+                    keep(px, 1);
+                }
+                if(!walkable(x, y - 1)) {
+                    keep(px, -1);
+                }
+            } else {
+                keep(0, py);
+                if(!walkable(x + 1, y)) {
+                    keep(1, py);
+                }
+                if(!walkable(x - 1, y)) {
+                    keep(-1, py);
+                }
+            }
+
+            const float g = m_g[index];
+            for(int i = 0; i < count; ++i) {
+                const int d    = directions[i];
+                const int next = m_precomputed
+                                     ? jump_table(x, y, d, gx, gy)
+                                     : jump(x, y, grid_dx[d], grid_dy[d], goal);
+                if(next < 0 || m_closed[next] == generation) {
+                    continue;
+                }
+                const int nx       = next % m_width;
+                const int ny       = next / m_width;
+                const float next_g = g + grid_distance<true>(nx - x, ny - y);
+                if(m_visited[next] == generation && m_g[next] <= next_g) {
+                    continue;
+                }
+                m_visited[next] = generation;
+                m_g[next]       = next_g;
+                m_parent[next]  = index;
+                const float f = next_g + grid_distance<true>(gx - nx, gy - ny);
+                const uint32_t key
+                    = std::max(radix_heap_t<int>::float_key(f),
+                               m_open.last_key());
+                m_open.push(key, next);
+            }
+        }
+        return result;
+    }
+};
+
+}  // namespace radl
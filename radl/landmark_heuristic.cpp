@@ -0,0 +1,247 @@
+#include "landmark_heuristic.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace radl {
+
+namespace {
+
+constexpr uint32_t file_magic   = 0x544c4152;  // "RALT"
+constexpr uint32_t file_version = 1;
+
+struct file_header_t {
+    uint32_t magic     = file_magic;
+    uint32_t version   = file_version;
+    int32_t width      = 0;
+    int32_t height     = 0;
+    int32_t count      = 0;
+    uint32_t symmetric = 1;
+};
+
+// Landmark positions follow the header, then the distances
+size_t distances_offset(const int count) {
+    return sizeof(file_header_t) + sizeof(int32_t) * 2 * count;
+}
+
+}  // namespace
+
+landmark_table_t::~landmark_table_t() {
+    release();
+}
+
+void landmark_table_t::build(dijkstra_map_t& map, const int count,
+                             const bool symmetric) {
+    const int width = map.width();
+    int seed_x      = -1;
+    int seed_y      = -1;
+    for(int cell = 0; cell < width * map.height() && seed_x < 0; ++cell) {
+        if(map.cost(cell % width, cell / width) != unreachable) {
+            seed_x = cell % width;
+            seed_y = cell / width;
+        }
+    }
+    build_tables(width, map.height(), count, symmetric, seed_x, seed_y,
+                 [&](const int x, const int y, std::vector<float>& distances) {
+                     map.clear();
+                     map.add_source(x, y);
+                     map.compute();
+                     for(size_t cell = 0; cell < distances.size(); ++cell) {
+                         distances[cell] = map.distance(
+                             static_cast<int>(cell % width),
+                             static_cast<int>(cell / width));
+                     }
+                 });
+}
+
+void landmark_table_t::build_tables(
+    const int width, const int height, const int count, const bool symmetric,
+    int next_x, int next_y,
+    const std::function<void(int, int, std::vector<float>&)>&
+        distances_from) {
+    release();
+    m_width     = width;
+    m_height    = height;
+    m_symmetric = symmetric;
+    const size_t tiles = static_cast<size_t>(m_width) * m_height;
+
+    // distance of every tile to its nearest landmark so far, the next one
+    // goes where it is highest
+    std::vector<float> nearest(tiles, unreachable);
+    std::vector<float> distances(tiles);
+    std::vector<std::vector<float>> tables;
+    // the first landmark is the tile furthest from the seed
+    bool seeding = true;
+    while(next_x >= 0 && static_cast<int>(tables.size()) < count) {
+        distances_from(next_x, next_y, distances);
+        if(!seeding) {
+            m_landmarks.emplace_back(next_x, next_y);
+            tables.push_back(distances);
+        }
+        // a one tile map still gets its landmark
+        float furthest = seeding ? -1.f : 0.f;
+        next_x         = -1;
+        for(size_t cell = 0; cell < tiles; ++cell) {
+            const float distance = distances[cell];
+            if(!seeding) {
+                nearest[cell] = std::min(nearest[cell], distance);
+            }
+            // only tiles linked to the landmarks, an enclosed pocket would
+            // waste one
+            const float score = seeding ? distance : nearest[cell];
+            if(distance != unreachable && score > furthest) {
+                furthest = score;
+                next_x   = static_cast<int>(cell % m_width);
+                next_y   = static_cast<int>(cell / m_width);
+            }
+        }
+        seeding = false;
+    }
+
+    m_count = static_cast<int>(tables.size());
+    m_owned.resize(tiles * m_count);
+    for(size_t cell = 0; cell < tiles; ++cell) {
+        for(int i = 0; i < m_count; ++i) {
+            m_owned[cell * m_count + i] = tables[i][cell];
+        }
+    }
+    m_distances = m_count > 0 ? m_owned.data() : nullptr;
+}
+
+void landmark_table_t::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file) {
+        throw std::runtime_error("Unable to write landmark table: " + path);
+    }
+    file_header_t header;
+    header.width     = m_width;
+    header.height    = m_height;
+    header.count     = m_count;
+    header.symmetric = m_symmetric ? 1 : 0;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for(const auto& [x, y] : m_landmarks) {
+        const int32_t position[2]{x, y};
+        file.write(reinterpret_cast<const char*>(position), sizeof(position));
+    }
+    if(m_distances) {
+        file.write(reinterpret_cast<const char*>(m_distances),
+                   static_cast<std::streamsize>(
+                       sizeof(float) * m_width * m_height * m_count));
+    }
+    if(!file) {
+        throw std::runtime_error("Unable to write landmark table: " + path);
+    }
+}
+
+void landmark_table_t::map_file(const std::string& path) {
+    release();
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if(file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Unable to open landmark table: " + path);
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    HANDLE mapping
+        = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+                         : nullptr;
+    CloseHandle(file);
+    if(!view) {
+        if(mapping) {
+            CloseHandle(mapping);
+        }
+        throw std::runtime_error("Unable to map landmark table: " + path);
+    }
+    m_file_handle = mapping;
+    m_map_size    = static_cast<size_t>(size.QuadPart);
+#else
+    const int file = open(path.c_str(), O_RDONLY);
+    if(file < 0) {
+        throw std::runtime_error("Unable to open landmark table: " + path);
+    }
+    struct stat info;
+    void* view = MAP_FAILED;
+    if(fstat(file, &info) == 0 && info.st_size > 0) {
+        view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ,
+                    MAP_SHARED, file, 0);
+    }
+    close(file);
+    if(view == MAP_FAILED) {
+        throw std::runtime_error("Unable to map landmark table: " + path);
+    }
+    m_map_size = static_cast<size_t>(info.st_size);
+#endif
+    m_mapping = view;
+
+    file_header_t header;
+    if(m_map_size >= sizeof(header)) {
+        std::memcpy(&header, m_mapping, sizeof(header));
+    }
+    const auto* bytes = static_cast<const std::byte*>(m_mapping);
+    const size_t expected
+        = distances_offset(header.count)
+          + sizeof(float) * static_cast<size_t>(header.width) * header.height
+                * header.count;
+    if(m_map_size < sizeof(header) || header.magic != file_magic
+       || header.version != file_version || header.count < 0
+       || header.width < 0 || header.height < 0 || m_map_size != expected) {
+        release();
+        throw std::runtime_error("Not a landmark table: " + path);
+    }
+    m_width     = header.width;
+    m_height    = header.height;
+    m_count     = header.count;
+    m_symmetric = header.symmetric != 0;
+    for(int i = 0; i < m_count; ++i) {
+        int32_t position[2];
+        std::memcpy(position,
+                    bytes + sizeof(header) + sizeof(position) * i,
+                    sizeof(position));
+        m_landmarks.emplace_back(position[0], position[1]);
+    }
+    m_distances
+        = m_count > 0 ? reinterpret_cast<const float*>(
+              bytes + distances_offset(m_count))
+                      : nullptr;
+}
+
+void landmark_table_t::release() noexcept {
+    if(m_mapping) {
+#if defined(_WIN32)
+        UnmapViewOfFile(m_mapping);
+        CloseHandle(static_cast<HANDLE>(m_file_handle));
+#else
+        munmap(m_mapping, m_map_size);
+#endif
+    }
+    m_mapping     = nullptr;
+    m_map_size    = 0;
+    m_file_handle = nullptr;
+    m_owned.clear();
+    m_owned.shrink_to_fit();
+    m_landmarks.clear();
+    m_distances = nullptr;
+    m_count     = 0;
+}
+
+}  // namespace radl
@@ -0,0 +1,286 @@
+/*
+ * ALT heuristics (A*, landmarks and the triangle inequality, Goldberg &
+ * Harrelson 2005) for large static maps. A few landmark tiles are picked far
+ * apart and the distance from each of them to every tile is stored. By the
+ * triangle inequality, d(L, goal) - d(L, pos) never exceeds the distance from
+ * pos to goal, for any landmark L: the best of those bounds sees walls that
+ * Manhattan or octile distances ignore, so A* expands far fewer nodes around
+ * them.
+ *
+ * The tables must hold distances in the moves of the navigator they serve,
+ * or in moves that never cost more: an estimate above the real cost makes A*
+ * miss shortest paths. build<location_t, navigator_t>() follows the
+ * navigator's own get_successors and get_cost when it has them. They hold
+ * one float per tile and landmark: save() writes them to a file and
+ * map_file() memory-maps one, for maps too large to keep the tables around.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dijkstra_map.hpp"
+#include "grid_path_finding.hpp"
+#include "radix_heap.hpp"
+
+namespace radl {
+
+/*
+ * A path_find navigator: landmark tables built from it follow its own moves
+ * and costs.
+ */
+template <typename navigator_t, typename location_t>
+concept move_navigator
+    = requires(location_t& loc, std::vector<location_t>& successors) {
+          navigator_t::get_successors(loc, successors);
+          { navigator_t::get_cost(loc, loc) } -> std::convertible_to<float>;
+      };
+
+class landmark_table_t {
+public:
+    static constexpr float unreachable = dijkstra_map_t::unreachable;
+
+private:
+    int m_width  = 0;
+    int m_height = 0;
+    int m_count  = 0;
+    // without tile costs d(L, a) - d(L, b) bounds both directions
+    bool m_symmetric = true;
+    std::vector<std::pair<int, int>> m_landmarks;
+    // tile major: the distances of all the landmarks to a tile are together
+    std::vector<float> m_owned;
+    const float* m_distances = nullptr;
+    // the mapped file, if any
+    void* m_mapping     = nullptr;
+    size_t m_map_size   = 0;
+    void* m_file_handle = nullptr;
+
+    inline const float* tile(const int x, const int y) const noexcept {
+        return m_distances
+               + (static_cast<size_t>(y) * m_width + x) * m_count;
+    }
+
+    inline bool inside(const int x, const int y) const noexcept {
+        return x >= 0 && y >= 0 && x < m_width && y < m_height;
+    }
+
+    /*
+     * Picks the landmarks, starting from the tile furthest from the walkable
+     * @p seed_x/@p seed_y (none when negative), and fills their tables.
+     * @p distances_from(x, y, out) writes the distance from x/y to every
+     * tile, y * width + x, into out.
+     */
+    void build_tables(
+        int width, int height, int count, bool symmetric, int seed_x,
+        int seed_y,
+        const std::function<void(int, int, std::vector<float>&)>&
+            distances_from);
+
+    /*
+     * Dijkstra from x/y over the moves of a path_find navigator.
+     */
+    template <typename location_t, typename navigator_t>
+    static void navigator_distances(const int width, const int height,
+                                    const int x, const int y,
+                                    std::vector<float>& distances,
+                                    radix_heap_t<int>& open,
+                                    std::vector<location_t>& successors) {
+        using heap_t = radix_heap_t<int>;
+        std::fill(distances.begin(), distances.end(), unreachable);
+        open.clear();
+        distances[static_cast<size_t>(y) * width + x] = 0.f;
+        open.push(heap_t::float_key(0.f), y * width + x);
+        while(!open.empty()) {
+            const auto [key, cell] = open.pop();
+            const float distance   = distances[cell];
+            if(heap_t::float_key(distance) != key) {
+                // lowered since it was pushed
+                continue;
+            }
+            location_t pos = navigator_t::get_xy(cell % width, cell / width);
+            successors.clear();
+            navigator_t::get_successors(pos, successors);
+            for(auto& next : successors) {
+                const int nx = navigator_t::get_x(next);
+                const int ny = navigator_t::get_y(next);
+                if(nx < 0 || ny < 0 || nx >= width || ny >= height) {
+                    continue;
+                }
+                const int index = ny * width + nx;
+                const float candidate
+                    = distance
+                      + static_cast<float>(navigator_t::get_cost(pos, next));
+                if(candidate < distances[index]) {
+                    distances[index] = candidate;
+                    open.push(heap_t::float_key(candidate), index);
+                }
+            }
+        }
+    }
+
+public:
+    landmark_table_t() = default;
+    ~landmark_table_t();
+
+    landmark_table_t(const landmark_table_t&)            = delete;
+    landmark_table_t& operator=(const landmark_table_t&) = delete;
+
+    /**
+     * @brief Picks @p count landmarks over the walkable tiles of @p map (its
+     * costs set, see dijkstra_map_t::set_costs) and computes their tables in
+     * its moves: 1 straight, sqrt(2) diagonal, times the cost of the tile
+     * stepped onto. Each landmark is the tile furthest from the ones before
+     * it.
+     *
+     * @param symmetric false if tile costs make a move cost differ from the
+     * move back
+     */
+    void build(dijkstra_map_t& map, int count, bool symmetric = true);
+
+    /**
+     * @brief Builds the tables of a grid navigator. A path_find navigator
+     * (get_successors and get_cost) is followed move by move, its costs must
+     * not be negative; any other grid navigator through a dijkstra_map_t of
+     * its walkability and tile costs.
+     *
+     * @param symmetric false if a move can cost more than the move back
+     */
+    template <typename location_t, typename navigator_t>
+        requires grid_navigator<navigator_t, location_t>
+    void build(const int width, const int height, const int count,
+               const bool symmetric
+               = !weighted_grid_navigator<navigator_t, location_t>) {
+        if constexpr(move_navigator<navigator_t, location_t>) {
+            int seed_x = -1;
+            int seed_y = -1;
+            for(int cell = 0; cell < width * height && seed_x < 0; ++cell) {
+                if(navigator_t::is_walkable(
+                       navigator_t::get_xy(cell % width, cell / width))) {
+                    seed_x = cell % width;
+                    seed_y = cell / width;
+                }
+            }
+            radix_heap_t<int> open;
+            std::vector<location_t> successors;
+            build_tables(width, height, count, symmetric, seed_x, seed_y,
+                         [&](const int x, const int y,
+                             std::vector<float>& distances) {
+                             navigator_distances<location_t, navigator_t>(
+                                 width, height, x, y, distances, open,
+                                 successors);
+                         });
+        } else {
+            dijkstra_map_t map(width, height);
+            map.set_costs<location_t, navigator_t>();
+            build(map, count, symmetric);
+        }
+    }
+
+    /**
+     * @brief Writes the tables to @p path, to be mapped later. Throws
+     * std::runtime_error if the file can't be written.
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief Uses the tables saved in @p path, memory-mapped read only: the
+     * pages are read in as the searches touch them. Throws
+     * std::runtime_error if the file can't be mapped or is not a table.
+     */
+    void map_file(const std::string& path);
+
+    /**
+     * @brief Drops the tables, unmapping the file if any.
+     */
+    void release() noexcept;
+
+    inline bool empty() const noexcept {
+        return m_distances == nullptr;
+    }
+
+    inline bool mapped() const noexcept {
+        return m_mapping != nullptr;
+    }
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    inline int landmark_count() const noexcept {
+        return m_count;
+    }
+
+    inline std::pair<int, int> landmark(const int index) const {
+        return m_landmarks[index];
+    }
+
+    /**
+     * @brief Distance from landmark @p index to x/y, unreachable if none.
+     */
+    inline float distance(const int index, const int x, const int y) const {
+        return tile(x, y)[index];
+    }
+
+    /**
+     * @brief Lower bound of the distance from x0/y0 to x1/y1, 0 when the
+     * landmarks tell nothing (none, or a tile outside the tables).
+     */
+    inline float estimate(const int x0, const int y0, const int x1,
+                          const int y1) const noexcept {
+        if(m_distances == nullptr || !inside(x0, y0) || !inside(x1, y1)) {
+            return 0.f;
+        }
+        const float* from = tile(x0, y0);
+        const float* to   = tile(x1, y1);
+        float best        = 0.f;
+        for(int i = 0; i < m_count; ++i) {
+            if(from[i] == unreachable || to[i] == unreachable) {
+                continue;
+            }
+            const float bound
+                = m_symmetric ? std::abs(to[i] - from[i]) : to[i] - from[i];
+            best = std::max(best, bound);
+        }
+        return best;
+    }
+};
+
+/*
+ * Adaptor giving a path_find navigator the landmark heuristic: its own
+ * get_distance_estimate is kept where it is higher. The table is a global (or
+ * static) one, passed by reference:
+ *
+ *   landmark_table_t landmarks;
+ *   using alt_navigator = landmark_navigator_t<navigator, landmarks>;
+ *   landmarks.build<location_t, navigator>(width, height, 8);
+ *   path_find<alt_navigator>(start, end);
+ *
+ * Build the table from the navigator itself (or saved from such a build):
+ * tables from a dijkstra_map_t assume sqrt(2) diagonals, and overestimate
+ * for a navigator whose moves cost less. The navigator needs get_x and
+ * get_y, like the grid path finders.
+ */
+template <typename navigator_t, const landmark_table_t& table_v>
+struct landmark_navigator_t : navigator_t {
+    template <typename location_t>
+    static float get_distance_estimate(location_t& pos, location_t& goal) {
+        const float estimate = table_v.estimate(
+            navigator_t::get_x(pos), navigator_t::get_y(pos),
+            navigator_t::get_x(goal), navigator_t::get_y(goal));
+        return std::max(static_cast<float>(
+                            navigator_t::get_distance_estimate(pos, goal)),
+                        estimate);
+    }
+};
+
+}  // namespace radl
@@ -1,12 +1,13 @@
 #include "layer_t.hpp"
 
 #include "input_handler.hpp"
+#include "raylib_backend.hpp"
 
 namespace radl {
 
 void layer_t::make_owner_draw_backing() {
     if(!backing) {
-        backing = std::make_unique<render_texture_t>(w, h);
+        backing = std::make_unique<render_target_t>(w, h);
     }
 }
 
@@ -74,10 +75,7 @@ void layer_t::render() {
             }
         }
 
-        for(auto& [handle, control] : controls) {
-            control->render(vterm.get());
-        }
-
+        render_controls();
         vterm->render();
 
     } else if(svterm) {
@@ -85,10 +83,23 @@ void layer_t::render() {
     } else {  // has backing
         // if backing doesn't exist, create one
         make_owner_draw_backing();
-        BeginTextureMode(backing->render_texture);
-        ClearBackground(BLANK);
-        owner_draw_func(this, backing->render_texture);
-        EndTextureMode();
+        auto& backend = get_render_backend();
+        backend.begin_target(backing->id());
+        backend.clear(BLANK);
+        // owner draw functions draw with raylib, other backends skip them
+        if(auto* raylib = dynamic_cast<raylib_backend*>(&backend)) {
+            owner_draw_func(this, raylib->render_texture(backing->id()));
+        }
+        backend.end_target();
+    }
+}
+
+void layer_t::render_controls() {
+    if(!vterm) {
+        return;
+    }
+    for(auto& [handle, control] : controls) {
+        control->render(vterm.get());
     }
 }
 
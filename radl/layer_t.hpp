@@ -50,7 +50,7 @@ struct layer_t {
     // Used for owner-draw layers. We need to render to texture and then compose
     // to: a) permit threading, should you so wish (so there is a single
     // composite run) b) allow the future "effects" engine to run.
-    std::unique_ptr<render_texture_t> backing;
+    std::unique_ptr<render_target_t> backing;
 
     layer_t(layer_t&& rhs) = default;
 
@@ -108,6 +108,10 @@ struct layer_t {
     // Called by GUI when a render event occurs.
     void render();
 
+    // Draws the retained mode controls into the console, without any mouse
+    // handling. Called by render.
+    void render_controls();
+
     void draw(bool yflipped = false);
 
     void clear();
@@ -0,0 +1,151 @@
+/*
+ * Growable node storage for the path finders. Nodes are carved out of
+ * chunks that double in size as the arena grows, freed nodes are recycled
+ * through a free list, and reset() drops every node at once in O(1) while
+ * keeping the chunks: an arena reused across searches (or kept thread_local)
+ * stops allocating once it has grown to the largest search.
+ *
+ * The arena hands out raw storage, construct and destroy in it like with
+ * operator new. reset() runs no destructors.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace radl {
+
+template <typename T>
+class node_arena_t {
+private:
+    // a free slot holds the next free slot
+    union slot_t {
+        slot_t* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    static constexpr size_t default_chunk_size = 256;
+    // chunks stop doubling at this size
+    static constexpr size_t max_chunk_size = 65536;
+
+    std::vector<std::unique_ptr<slot_t[]>> m_chunks;
+    std::vector<size_t> m_chunk_sizes;
+    // chunk being carved and the next untouched slot in it
+    size_t m_chunk   = 0;
+    size_t m_used    = 0;
+    slot_t* m_free   = nullptr;
+    size_t m_live    = 0;
+    size_t m_peak    = 0;
+    size_t m_slots   = 0;
+    size_t m_resets  = 0;
+    size_t m_initial = default_chunk_size;
+
+    void add_chunk() {
+        const size_t grown
+            = std::min(m_chunk_sizes.empty() ? 0 : m_chunk_sizes.back() * 2,
+                       max_chunk_size);
+        const size_t size = std::max(m_initial, grown);
+        m_chunks.push_back(std::make_unique_for_overwrite<slot_t[]>(size));
+        m_chunk_sizes.push_back(size);
+        m_slots += size;
+    }
+
+public:
+    /**
+     * @param initial_nodes size of the first chunk, allocated on first use
+     */
+    explicit node_arena_t(const size_t initial_nodes = default_chunk_size)
+        : m_initial(std::max<size_t>(initial_nodes, 1)) {
+    }
+
+    node_arena_t(const node_arena_t&)            = delete;
+    node_arena_t& operator=(const node_arena_t&) = delete;
+
+    /**
+     * @brief Storage for one T, never nullptr (throws std::bad_alloc like
+     * new).
+     */
+    void* allocate() {
+        void* result = nullptr;
+        if(m_free) {
+            result = m_free;
+            m_free = m_free->next;
+        } else {
+            while(m_chunk < m_chunks.size()
+                  && m_used == m_chunk_sizes[m_chunk]) {
+                ++m_chunk;
+                m_used = 0;
+            }
+            if(m_chunk == m_chunks.size()) {
+                add_chunk();
+            }
+            result = &m_chunks[m_chunk][m_used++];
+        }
+        m_peak = std::max(m_peak, ++m_live);
+        return result;
+    }
+
+    /**
+     * @brief Returns one node's storage, to be handed out again.
+     */
+    void free(T* node) noexcept {
+        auto* slot = reinterpret_cast<slot_t*>(node);
+        slot->next = m_free;
+        m_free     = slot;
+        --m_live;
+    }
+
+    /**
+     * @brief Forgets every node, keeping the chunks for the next use.
+     */
+    void reset() noexcept {
+        m_chunk = 0;
+        m_used  = 0;
+        m_free  = nullptr;
+        m_live  = 0;
+        ++m_resets;
+    }
+
+    /**
+     * @brief Gives the chunks back to the system.
+     */
+    void release() noexcept {
+        reset();
+        m_chunks.clear();
+        m_chunk_sizes.clear();
+        m_slots = 0;
+    }
+
+    // Nodes handed out and not freed since the last reset
+    inline size_t size() const noexcept {
+        return m_live;
+    }
+
+    // Most nodes alive at once since construction (or clear_stats)
+    inline size_t high_water_mark() const noexcept {
+        return m_peak;
+    }
+
+    // Nodes the chunks can hold
+    inline size_t capacity() const noexcept {
+        return m_slots;
+    }
+
+    inline size_t chunk_count() const noexcept {
+        return m_chunks.size();
+    }
+
+    inline size_t reset_count() const noexcept {
+        return m_resets;
+    }
+
+    void clear_stats() noexcept {
+        m_peak   = m_live;
+        m_resets = 0;
+    }
+};
+
+}  // namespace radl
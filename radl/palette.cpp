@@ -0,0 +1,80 @@
+#include "palette.hpp"
+
+#include <bit>
+#include <stdexcept>
+
+namespace radl {
+
+palette_t::palette_t(std::initializer_list<color_t> colors) {
+    for(const auto& color : colors) {
+        if(m_size == max_size) {
+            throw std::runtime_error("Palette can't hold more than 256 colors");
+        }
+        m_colors[m_size]    = color;
+        m_sources[m_size++] = color;
+    }
+    rebuild_lookup();
+}
+
+void palette_t::insert_lookup(const uint32_t key, const uint8_t index) {
+    uint32_t slot = lookup_start(key);
+    while(m_lookup_slots[slot] != 0) {
+        if(m_lookup_keys[slot] == key) {
+            return;  // the first index holding the color wins
+        }
+        slot = (slot + 1) % lookup_size;
+    }
+    m_lookup_keys[slot]  = key;
+    m_lookup_slots[slot] = static_cast<uint16_t>(index + 1);
+}
+
+void palette_t::rebuild_lookup() {
+    m_lookup_slots.fill(0);
+    for(int i = 0; i < m_size; ++i) {
+        insert_lookup(std::bit_cast<uint32_t>(m_sources[i]),
+                      static_cast<uint8_t>(i));
+    }
+}
+
+uint8_t palette_t::add(const color_t& color) {
+    if(const auto index = find(color)) {
+        return *index;
+    }
+    if(m_size == max_size) {
+        throw std::runtime_error("Palette can't hold more than 256 colors");
+    }
+    const auto index = static_cast<uint8_t>(m_size++);
+    m_colors[index]  = color;
+    m_sources[index] = color;
+    insert_lookup(std::bit_cast<uint32_t>(color), index);
+    return index;
+}
+
+void palette_t::set(const uint8_t index, const color_t& color) {
+    if(index >= m_size) {
+        throw std::runtime_error("Palette index out of range");
+    }
+    m_colors[index] = color;
+}
+
+void palette_t::recolor(const palette_t& colors) {
+    if(colors.m_size != m_size) {
+        throw std::runtime_error("Can't recolor a palette of another size");
+    }
+    m_colors = colors.m_colors;
+}
+
+palette_t palette_t::lerp(const palette_t& first, const palette_t& second,
+                          const float amount) {
+    if(first.m_size != second.m_size) {
+        throw std::runtime_error("Can't lerp palettes of different sizes");
+    }
+    palette_t result = first;
+    for(int i = 0; i < result.m_size; ++i) {
+        result.m_colors[i]
+            = color_t::lerp(first.m_colors[i], second.m_colors[i], amount);
+    }
+    return result;
+}
+
+}  // namespace radl
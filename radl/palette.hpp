@@ -0,0 +1,178 @@
+/*
+ * Color palettes for the compact (palette indexed) cells of a virtual
+ * terminal: a cell stores a 16-bit glyph plus the palette indices of its
+ * foreground and background, 4 bytes in total. Recoloring or fading a whole
+ * terminal is then a matter of changing at most 256 palette entries.
+ *
+ * Each entry keeps the color it was added with (its source color) apart from
+ * the color it resolves to. Colors are encoded through their source, so the
+ * game keeps writing its usual colors while the entries are recolored.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+
+#include "color_t.hpp"
+#include "colors.hpp"
+
+namespace radl {
+
+/*
+ * A palette indexed character, packed into 32 bits as
+ * glyph | foreground << 16 | background << 24.
+ */
+struct palette_cell_t {
+    uint16_t glyph     = 0;
+    uint8_t foreground = 0;
+    uint8_t background = 0;
+
+    inline uint32_t pack() const noexcept {
+        return uint32_t{glyph} | (uint32_t{foreground} << 16)
+               | (uint32_t{background} << 24);
+    }
+
+    static inline palette_cell_t unpack(const uint32_t packed) noexcept {
+        return palette_cell_t{
+            static_cast<uint16_t>(packed & 0xffff),
+            static_cast<uint8_t>((packed >> 16) & 0xff),
+            static_cast<uint8_t>(packed >> 24),
+        };
+    }
+
+    bool operator==(const palette_cell_t& rhs) const = default;
+};
+
+class palette_t {
+public:
+    static constexpr int max_size = 256;
+
+private:
+    // what the indices resolve to
+    std::array<color_t, max_size> m_colors;
+    // what the indices were added with
+    std::array<color_t, max_size> m_sources;
+    int m_size = 0;
+    // source color -> first index holding it, a flat open addressing table
+    // since every palette cell write looks up two colors. A slot holds its
+    // index + 1, 0 when empty
+    static constexpr uint32_t lookup_size = 2 * max_size;
+    std::array<uint32_t, lookup_size> m_lookup_keys{};
+    std::array<uint16_t, lookup_size> m_lookup_slots{};
+
+    // Fibonacci hashing: the top bits of the product
+    static inline uint32_t lookup_start(const uint32_t key) noexcept {
+        return (key * 0x9e3779b1u) >> (32 - std::countr_zero(lookup_size));
+    }
+
+    void insert_lookup(uint32_t key, uint8_t index);
+    void rebuild_lookup();
+
+public:
+    /**
+     * @brief Creates a palette holding colors::NONE at index 0, so cells
+     * without a background don't need an entry of their own.
+     */
+    palette_t() {
+        add(colors::NONE);
+    }
+
+    /**
+     * @brief Creates a palette holding @p colors, in order.
+     */
+    palette_t(std::initializer_list<color_t> colors);
+
+    /**
+     * @brief Returns the index of @p color, appending it if it is not in the
+     * palette yet. Throws if the palette is full.
+     */
+    uint8_t add(const color_t& color);
+
+    /**
+     * @brief Makes @p index resolve to @p color, e.g. to recolor every cell
+     * using it. Its source color still encodes to it.
+     */
+    void set(uint8_t index, const color_t& color);
+
+    /**
+     * @brief Makes every index resolve to the color of @p colors at the same
+     * index, keeping the source colors. Throws if the sizes differ.
+     */
+    void recolor(const palette_t& colors);
+
+    inline std::optional<uint8_t> find(const color_t& color) const noexcept {
+        const auto key = std::bit_cast<uint32_t>(color);
+        // never full, an empty slot ends every probe
+        uint32_t slot = lookup_start(key);
+        while(m_lookup_slots[slot] != 0) {
+            if(m_lookup_keys[slot] == key) {
+                return static_cast<uint8_t>(m_lookup_slots[slot] - 1);
+            }
+            slot = (slot + 1) % lookup_size;
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Returns the index of the source color @p color, throws if it is
+     * not in the palette.
+     */
+    inline uint8_t index_of(const color_t& color) const {
+        if(const auto index = find(color)) {
+            return *index;
+        }
+        throw std::runtime_error("Color not in palette");
+    }
+
+    /**
+     * @brief The color @p index resolves to.
+     */
+    inline const color_t& operator[](const uint8_t index) const noexcept {
+        assert(index < m_size);
+        return m_colors[index];
+    }
+
+    /**
+     * @brief The color @p index was added with.
+     */
+    inline const color_t& source(const uint8_t index) const noexcept {
+        assert(index < m_size);
+        return m_sources[index];
+    }
+
+    inline int size() const noexcept {
+        return m_size;
+    }
+
+    inline const color_t* data() const noexcept {
+        return m_colors.data();
+    }
+
+    /**
+     * @brief Encodes @p glyph/@p fg/@p bg as a palette cell. Throws if a
+     * color is not in the palette or the glyph doesn't fit in 16 bits.
+     */
+    inline palette_cell_t encode(const uint32_t glyph, const color_t& fg,
+                                 const color_t& bg) const {
+        if(glyph > UINT16_MAX) {
+            throw std::runtime_error("Glyph too large for a palette cell");
+        }
+        return palette_cell_t{static_cast<uint16_t>(glyph), index_of(fg),
+                              index_of(bg)};
+    }
+
+    /**
+     * @brief Entry by entry color_t::lerp of two palettes of the same size,
+     * for fades. The result keeps the source colors of @p first.
+     */
+    static palette_t lerp(const palette_t& first, const palette_t& second,
+                          float amount);
+};
+
+}  // namespace radl
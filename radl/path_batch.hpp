@@ -0,0 +1,64 @@
+/*
+ * Many path_find calls at once, spread over a thread pool. Each worker keeps
+ * its own search (lists and node arena) from one batch to the next, so a
+ * turn of pathing for hundreds of agents allocates little beyond the
+ * resulting steps.
+ *
+ * The navigator is called from several threads at the same time: it must
+ * only read the map, and the map must not change during the batch.
+ */
+
+#pragma once
+
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "astar.hpp"
+#include "path_finding.hpp"
+#include "thread_pool.hpp"
+
+namespace radl {
+
+/**
+ * @brief Runs path_find for every (start, goal) pair of @p requests, writing
+ * the paths in the matching slots of @p results.
+ *
+ * @param results as long as @p requests; existing steps storage is reused
+ * @param limit_steps, heuristic_weight as in path_find, per search
+ */
+template <typename Navigator, typename Location>
+void path_find_batch(
+    thread_pool_t& pool,
+    const std::span<const std::pair<Location, Location>> requests,
+    const std::span<astar_path_t<Location>> results,
+    const size_t limit_steps = 100, const float heuristic_weight = 1.f) {
+    if(results.size() != requests.size()) {
+        throw std::runtime_error(
+            "path_find_batch: results and requests differ in size");
+    }
+    using search_t = AStarSearch<search_node_t<Location, Navigator>>;
+    pool.parallel_for(requests.size(), [&](const size_t index, size_t) {
+        // one per thread, so per worker and kept between batches
+        thread_local search_t search;
+        const auto& [start, goal] = requests[index];
+        path_find_into<Navigator>(search, start, goal, results[index],
+                                  limit_steps, heuristic_weight);
+    });
+}
+
+/**
+ * @brief path_find_batch on the default pool, one worker per hardware
+ * thread.
+ */
+template <typename Navigator, typename Location>
+void path_find_batch(
+    const std::span<const std::pair<Location, Location>> requests,
+    const std::span<astar_path_t<Location>> results,
+    const size_t limit_steps = 100, const float heuristic_weight = 1.f) {
+    path_find_batch<Navigator, Location>(default_thread_pool(), requests,
+                                         results, limit_steps,
+                                         heuristic_weight);
+}
+
+}  // namespace radl
@@ -1,29 +1,81 @@
 #pragma once
 
+#include <chrono>
 #include <concepts>
+#include <cstddef>
 #include <deque>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "astar.hpp"
 #include "geometry.hpp"
+#include "inline_vector.hpp"
+#include "path_stats.hpp"
 
 namespace radl {
 
-// Template class used to define what a navigation path looks like
-template <typename location_t> struct astar_path_t {
+// Template class used to define what a navigation path looks like. steps_t
+// can be any container with clear, push_back, front and pop_front, e.g. a
+// std::vector reused by path_find_into or a compact_path_t
+template <typename location_t, typename steps_t = std::deque<location_t>>
+struct astar_path_t {
   // if true: the path was found, false otherwise
   bool success = false;
   location_t destination;
-  // deque containing all the steps towards the destination after using the
+  // all the steps towards the destination after using the
   // path_find(start, end)
-  std::deque<location_t> steps;
+  steps_t steps;
 };
 
+// Optional navigator hook: a static get_hash(location) makes the A* open and
+// closed list lookups O(1). Locations that are is_same_state must hash equally,
+// e.g. map.at(x, y) for a grid.
+template <typename navigator_t, typename location_t>
+concept hashable_navigator = requires(location_t &loc) {
+  { navigator_t::get_hash(loc) } -> std::convertible_to<std::size_t>;
+};
+
+// Optional navigator hook: a static is_reachable(from, to) that is false
+// when no path can link them (e.g. region_map_t::connected) makes path_find
+// fail at once instead of searching until limit_steps. path_find_batch calls
+// it from its workers, it must not modify anything.
+template <typename navigator_t, typename location_t>
+concept reachability_navigator = requires(const location_t &loc) {
+  { navigator_t::is_reachable(loc, loc) } -> std::convertible_to<bool>;
+};
+
+// Most successors a navigator gives for one location, 8 unless it declares
+// static constexpr std::size_t max_successors. Giving more throws
+// std::runtime_error from the search
+template <typename navigator_t> constexpr std::size_t max_successors() {
+  if constexpr (requires { navigator_t::max_successors; }) {
+    return navigator_t::max_successors;
+  } else {
+    return 8;
+  }
+}
+
+// The successors of one location, on the stack
+template <typename location_t, typename navigator_t>
+using successor_buffer_t =
+    inline_vector_t<location_t, max_successors<navigator_t>()>;
+
+// Optional navigator hook: a get_successors taking a successor_buffer_t
+// (usually a template over the container, push_back is all it needs) lets
+// every expansion skip the heap
+template <typename navigator_t, typename location_t>
+concept buffered_successor_navigator =
+    requires(location_t loc,
+             successor_buffer_t<location_t, navigator_t> &successors) {
+      navigator_t::get_successors(loc, successors);
+    };
+
 // The A* library also requires a helper class to understand your map format.
+// It has the AStarState functions without deriving from it: with no virtual
+// destructor the nodes of a search are dropped at once instead of one by one.
 template <typename location_t, typename navigator_t>
-class search_node_t final
-    : public AStarState<search_node_t<location_t, navigator_t>> {
+class search_node_t final {
   using SearchNode_t = search_node_t<location_t, navigator_t>;
 
 public:
@@ -44,15 +96,28 @@ public:
   bool GetSuccessors(
       AStarSearch<search_node_t<location_t, navigator_t>> *a_star_search,
       search_node_t<location_t, navigator_t> *parent_node) {
-    std::vector<location_t> successors;
-    navigator_t::get_successors(pos, successors);
-    for (const auto &loc : successors) {
+    auto add = [&](const location_t &loc) {
       // skip the parent node, makes to set a backwards position as a
       // successor
       if (parent_node && (loc == parent_node->pos)) {
-        continue;
+        return;
       }
       a_star_search->AddSuccessor(search_node_t<location_t, navigator_t>{loc});
+    };
+    if constexpr (buffered_successor_navigator<navigator_t, location_t>) {
+      successor_buffer_t<location_t, navigator_t> successors;
+      navigator_t::get_successors(pos, successors);
+      for (const auto &loc : successors) {
+        add(loc);
+      }
+    } else {
+      // one vector per thread, cleared instead of built on every expansion
+      thread_local std::vector<location_t> successors;
+      successors.clear();
+      navigator_t::get_successors(pos, successors);
+      for (const auto &loc : successors) {
+        add(loc);
+      }
     }
     return true;
   }
@@ -66,16 +131,47 @@ public:
     bool result = navigator_t::is_same_state(pos, rhs.pos);
     return result;
   }
+
+  std::size_t Hash()
+    requires hashable_navigator<navigator_t, location_t>
+  {
+    return static_cast<std::size_t>(navigator_t::get_hash(pos));
+  }
 };
 
-template <typename Navigator, typename Location>
-astar_path_t<Location> path_find(const Location &start, const Location &end,
-                                 size_t limit_steps = 100) {
+// path_find on a search object of your own, writing into @p result: the
+// search keeps its lists and nodes and the result its steps from one call to
+// the next. With a hashable, buffered navigator and steps that keep their
+// storage on clear (std::vector, compact_path_t) a loop over many paths
+// allocates nothing once everything has grown to the longest search.
+template <typename Navigator, typename Location, typename Steps>
+void path_find_into(
+    AStarSearch<search_node_t<Location, Navigator>> &a_star_search,
+    const Location &start, const Location &end,
+    astar_path_t<Location, Steps> &result, size_t limit_steps = 100,
+    float heuristic_weight = 1.f) {
   using user_node_t = search_node_t<Location, Navigator>;
+  using clock = std::chrono::steady_clock;
+  result.success = false;
+  result.destination = end;
+  result.steps.clear();
+  // only read the clock for a collector
+  auto *const collector = get_path_stats_collector();
+  if constexpr (reachability_navigator<Navigator, Location>) {
+    if (!Navigator::is_reachable(start, end)) {
+      if (collector) {
+        // a failed search that cost nothing
+        collector->record(path_search_stats_t{});
+      }
+      return;
+    }
+  }
+  const auto started = collector ? clock::now() : clock::time_point{};
+
   auto a_start = user_node_t(start);
   auto a_end = user_node_t(end);
-  auto a_star_search = AStarSearch<user_node_t>();
 
+  a_star_search.SetHeuristicWeight(heuristic_weight);
   a_star_search.SetStartAndGoalStates(a_start, a_end);
   unsigned int search_state = 0;
   std::size_t search_steps = 0;
@@ -88,7 +184,6 @@ astar_path_t<Location> path_find(const Location &start, const Location &end,
     }
   } while (search_state == AStarSearch<user_node_t>::kSearchStateSearching);
 
-  auto result = astar_path_t<Location>{false, end};
   if (search_state == AStarSearch<user_node_t>::kSearchStateSucceeded) {
     for (auto *node = a_star_search.GetSolutionStart(); node;
          node = a_star_search.GetSolutionNext()) {
@@ -98,6 +193,34 @@ astar_path_t<Location> path_find(const Location &start, const Location &end,
     result.success = true;
   }
   a_star_search.EnsureMemoryFreed();
+
+  if (collector) {
+    const auto &stats = a_star_search.GetStats();
+    const std::chrono::duration<double, std::micro> elapsed =
+        clock::now() - started;
+    collector->record(path_search_stats_t{
+        static_cast<size_t>(stats.expanded),
+        static_cast<size_t>(stats.pushes), static_cast<size_t>(stats.pops),
+        static_cast<size_t>(stats.rejected),
+        static_cast<size_t>(stats.peak_open),
+        static_cast<size_t>(stats.peak_nodes), elapsed.count(),
+        result.success});
+  }
+}
+
+// heuristic_weight above 1 trades path quality for speed: the path costs at
+// most that many times the shortest one, for far fewer expanded nodes
+template <typename Navigator, typename Location>
+astar_path_t<Location> path_find(const Location &start, const Location &end,
+                                 size_t limit_steps = 100,
+                                 float heuristic_weight = 1.f) {
+  using user_node_t = search_node_t<Location, Navigator>;
+  // The search, its lists and its node arena are kept per thread, so after
+  // the first few calls path_find only allocates the returned steps
+  thread_local AStarSearch<user_node_t> a_star_search;
+  auto result = astar_path_t<Location>{false, end};
+  path_find_into<Navigator>(a_star_search, start, end, result, limit_steps,
+                            heuristic_weight);
   return result;
 }
 
@@ -0,0 +1,254 @@
+/*
+ * Time-sliced path finding. A path_request_t is an AStarSearch that can be
+ * stepped for a time (or expansion) budget and resumed later, so a long
+ * search is spread over frames instead of stalling one, or being cut short by
+ * path_find's limit_steps.
+ *
+ * path_scheduler_t runs many requests within a per frame budget: call
+ * update() once a frame, every pending request gets a turn in round-robin
+ * order, and the ones still searching carry on at the next frame.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "astar.hpp"
+#include "path_finding.hpp"
+#include "search_deadline.hpp"
+
+namespace radl {
+
+enum class path_request_state_t {
+    searching,
+    succeeded,
+    failed,
+};
+
+template <typename navigator_t, typename location_t>
+class path_request_t {
+private:
+    using node_t   = search_node_t<location_t, navigator_t>;
+    using search_t = AStarSearch<node_t>;
+
+    std::unique_ptr<search_t> m_search;
+    astar_path_t<location_t> m_path;
+    path_request_state_t m_state = path_request_state_t::searching;
+    size_t m_expanded            = 0;
+    size_t m_limit_steps         = 0;
+
+    void finish(const unsigned int search_state) {
+        if(search_state == search_t::kSearchStateSucceeded) {
+            for(auto* node = m_search->GetSolutionStart(); node;
+                node       = m_search->GetSolutionNext()) {
+                m_path.steps.push_back(node->pos);
+            }
+            m_search->FreeSolutionNodes();
+            m_path.success = true;
+            m_state        = path_request_state_t::succeeded;
+        } else {
+            m_state = path_request_state_t::failed;
+        }
+        // the node pool itself goes with the request, releasing a large
+        // one here would eat into the frame budget
+        m_search->EnsureMemoryFreed();
+    }
+
+    path_request_state_t run(search_deadline_t deadline,
+                             const size_t expansions) {
+        if(m_state != path_request_state_t::searching) {
+            return m_state;
+        }
+        for(size_t i = 0; i < expansions; ++i) {
+            if(m_expanded == m_limit_steps) {
+                m_search->CancelSearch();
+            }
+            const unsigned int search_state = m_search->SearchStep();
+            ++m_expanded;
+            if(search_state != search_t::kSearchStateSearching) {
+                finish(search_state);
+                break;
+            }
+            if(deadline.expired()) {
+                break;
+            }
+        }
+        return m_state;
+    }
+
+public:
+    /**
+     * @param limit_steps fail after expanding this many nodes in total
+     * @param reserve_nodes nodes to make room for up front, more are
+     * allocated as the search grows
+     */
+    path_request_t(
+        const location_t& start, const location_t& end,
+        const size_t limit_steps = std::numeric_limits<size_t>::max(),
+        const int reserve_nodes  = 1000)
+        : m_search(std::make_unique<search_t>(reserve_nodes)),
+          m_path{false, end},
+          m_limit_steps(limit_steps) {
+        if constexpr(reachability_navigator<navigator_t, location_t>) {
+            if(!navigator_t::is_reachable(start, end)) {
+                m_state = path_request_state_t::failed;
+                return;
+            }
+        }
+        auto a_start = node_t(start);
+        auto a_end   = node_t(end);
+        m_search->SetStartAndGoalStates(a_start, a_end);
+    }
+
+    path_request_t(path_request_t&&) = default;
+
+    // the search being replaced is cancelled, as if destroyed
+    path_request_t& operator=(path_request_t&& other) noexcept {
+        if(this != &other) {
+            cancel();
+            m_search      = std::move(other.m_search);
+            m_path        = std::move(other.m_path);
+            m_state       = other.m_state;
+            m_expanded    = other.m_expanded;
+            m_limit_steps = other.m_limit_steps;
+        }
+        return *this;
+    }
+
+    ~path_request_t() {
+        cancel();
+    }
+
+    /**
+     * @brief Searches for up to @p budget, then returns. Call again to
+     * resume.
+     */
+    path_request_state_t step(const std::chrono::microseconds budget) {
+        return run(search_deadline_t(budget),
+                   std::numeric_limits<size_t>::max());
+    }
+
+    /**
+     * @brief Expands at most @p expansions nodes, then returns. Call again
+     * to resume.
+     */
+    path_request_state_t step_expansions(const size_t expansions) {
+        return run(search_deadline_t(), expansions);
+    }
+
+    /**
+     * @brief Gives up the search, freeing its nodes.
+     */
+    void cancel() {
+        if(m_search && m_state == path_request_state_t::searching) {
+            // the next step frees the nodes and fails
+            m_search->CancelSearch();
+            finish(m_search->SearchStep());
+        }
+    }
+
+    inline path_request_state_t state() const noexcept {
+        return m_state;
+    }
+
+    inline bool done() const noexcept {
+        return m_state != path_request_state_t::searching;
+    }
+
+    /**
+     * @brief Nodes expanded so far, over every step.
+     */
+    inline size_t expanded() const noexcept {
+        return m_expanded;
+    }
+
+    /**
+     * @brief The path once done(), success is false while searching.
+     */
+    inline astar_path_t<location_t>& result() noexcept {
+        return m_path;
+    }
+};
+
+template <typename navigator_t, typename location_t>
+class path_scheduler_t {
+public:
+    using request_t = path_request_t<navigator_t, location_t>;
+
+private:
+    // below this the clock reads would cost more than the searching
+    static constexpr std::chrono::microseconds min_slice{20};
+
+    std::deque<std::shared_ptr<request_t>> m_pending;
+
+public:
+    /**
+     * @brief Queues a search. Keep the returned request and check done() on
+     * it; dropping it cancels the search at the next update().
+     */
+    std::shared_ptr<request_t> submit(
+        const location_t& start, const location_t& end,
+        const size_t limit_steps = std::numeric_limits<size_t>::max(),
+        const int reserve_nodes  = 1000) {
+        auto request = std::make_shared<request_t>(start, end, limit_steps,
+                                                   reserve_nodes);
+        m_pending.push_back(request);
+        return request;
+    }
+
+    inline size_t pending() const noexcept {
+        return m_pending.size();
+    }
+
+    /**
+     * @brief Frees the requests nobody holds anymore, then steps the pending
+     * ones for @p budget in total, splitting it evenly between them.
+     * Requests that did not get a turn go first at the next update, the
+     * unfinished ones rejoin the back of the queue.
+     */
+    void update(const std::chrono::microseconds budget
+                = std::chrono::microseconds{1000}) {
+        // the last reference goes, the destructor cancels the search
+        std::erase_if(m_pending, [](const std::shared_ptr<request_t>& request) {
+            return request.use_count() == 1;
+        });
+        using clock    = std::chrono::steady_clock;
+        auto now       = clock::now();
+        const auto end = now + budget;
+        size_t turns   = m_pending.size();
+        // no turn shorter than min_slice, and none that would end past the
+        // budget
+        while(turns > 0 && end - now >= min_slice) {
+            auto request = std::move(m_pending.front());
+            m_pending.pop_front();
+            --turns;
+            const auto left = std::chrono::duration_cast<
+                std::chrono::microseconds>(end - now);
+            const auto slice = std::max(
+                min_slice,
+                left / static_cast<std::chrono::microseconds::rep>(turns + 1));
+            if(request->step(slice) == path_request_state_t::searching) {
+                m_pending.push_back(std::move(request));
+            }
+            now = clock::now();
+        }
+    }
+
+    /**
+     * @brief Cancels every pending request.
+     */
+    void clear() {
+        for(auto& request : m_pending) {
+            request->cancel();
+        }
+        m_pending.clear();
+    }
+};
+
+}  // namespace radl
@@ -0,0 +1,21 @@
+#include "path_stats.hpp"
+
+#include <atomic>
+
+namespace radl {
+
+namespace {
+
+std::atomic<path_stats_collector_t*> collector{nullptr};
+
+}  // namespace
+
+void set_path_stats_collector(path_stats_collector_t* const stats) noexcept {
+    collector.store(stats, std::memory_order_release);
+}
+
+path_stats_collector_t* get_path_stats_collector() noexcept {
+    return collector.load(std::memory_order_acquire);
+}
+
+}  // namespace radl
@@ -0,0 +1,204 @@
+/*
+ * Path finding statistics for tuning in production builds. Every path_find
+ * reports what its search cost (nodes expanded, heap pushes and pops,
+ * rejected successors, peak open list and node counts, wall time) to the
+ * collector set with set_path_stats_collector(), if any. The collector sums
+ * them per frame, with histograms of the cost of single searches, and keeps
+ * a histogram of the time spent pathing per frame over all frames.
+ *
+ * With no collector set a search only pays for a few counter increments.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace radl {
+
+/*
+ * Cost of one search.
+ */
+struct path_search_stats_t {
+    size_t expanded   = 0;
+    size_t pushes     = 0;
+    size_t pops       = 0;
+    size_t rejected   = 0;
+    size_t peak_open  = 0;
+    size_t peak_nodes = 0;
+    double micros     = 0.0;
+    bool success      = false;
+};
+
+/*
+ * Histogram with power of two buckets: bucket i counts the values in
+ * [2^(i-1), 2^i), bucket 0 the zeros.
+ */
+class path_stats_histogram_t {
+public:
+    static constexpr size_t bucket_count = 40;
+
+private:
+    std::array<uint32_t, bucket_count> m_buckets{};
+    size_t m_count = 0;
+    double m_sum   = 0.0;
+    double m_max   = 0.0;
+
+public:
+    inline void add(const double value) noexcept {
+        const auto whole = static_cast<uint64_t>(std::max(value, 0.0));
+        const size_t bucket
+            = std::min<size_t>(std::bit_width(whole), bucket_count - 1);
+        ++m_buckets[bucket];
+        ++m_count;
+        m_sum += value;
+        m_max = std::max(m_max, value);
+    }
+
+    inline void clear() noexcept {
+        *this = path_stats_histogram_t{};
+    }
+
+    inline size_t count() const noexcept {
+        return m_count;
+    }
+
+    inline double sum() const noexcept {
+        return m_sum;
+    }
+
+    inline double max() const noexcept {
+        return m_max;
+    }
+
+    inline double mean() const noexcept {
+        return m_count ? m_sum / static_cast<double>(m_count) : 0.0;
+    }
+
+    inline uint32_t bucket(const size_t index) const noexcept {
+        return m_buckets[index];
+    }
+
+    /**
+     * @brief Upper bound of the bucket holding the @p fraction quantile
+     * (0.5 median, 0.99...), 0 when empty.
+     */
+    double quantile(const double fraction) const noexcept {
+        const auto target
+            = static_cast<size_t>(fraction * static_cast<double>(m_count));
+        size_t seen = 0;
+        for(size_t i = 0; i < bucket_count; ++i) {
+            seen += m_buckets[i];
+            if(seen > target) {
+                return std::min(i == 0 ? 0.0
+                                       : static_cast<double>(uint64_t{1} << i),
+                                m_max);
+            }
+        }
+        return m_max;
+    }
+};
+
+class path_stats_collector_t {
+public:
+    /*
+     * Totals of a frame, and the distribution of its single searches.
+     */
+    struct frame_t {
+        size_t searches   = 0;
+        size_t failed     = 0;
+        size_t expanded   = 0;
+        size_t pushes     = 0;
+        size_t pops       = 0;
+        size_t rejected   = 0;
+        size_t peak_open  = 0;
+        size_t peak_nodes = 0;
+        double micros     = 0.0;
+        path_stats_histogram_t search_expanded;
+        path_stats_histogram_t search_micros;
+    };
+
+private:
+    mutable std::mutex m_mutex;
+    frame_t m_current;
+    frame_t m_last;
+    // time spent pathing per frame, over every frame
+    path_stats_histogram_t m_frame_micros;
+    size_t m_frames = 0;
+
+public:
+    /**
+     * @brief Adds a search to the current frame. Thread safe, searches of a
+     * path_find_batch report from the workers.
+     */
+    void record(const path_search_stats_t& stats) {
+        const std::lock_guard lock(m_mutex);
+        ++m_current.searches;
+        m_current.failed += stats.success ? 0 : 1;
+        m_current.expanded += stats.expanded;
+        m_current.pushes += stats.pushes;
+        m_current.pops += stats.pops;
+        m_current.rejected += stats.rejected;
+        m_current.peak_open = std::max(m_current.peak_open, stats.peak_open);
+        m_current.peak_nodes
+            = std::max(m_current.peak_nodes, stats.peak_nodes);
+        m_current.micros += stats.micros;
+        m_current.search_expanded.add(static_cast<double>(stats.expanded));
+        m_current.search_micros.add(stats.micros);
+    }
+
+    /**
+     * @brief Closes the current frame, call once per frame: it becomes
+     * last_frame() and the next searches count towards a new one.
+     */
+    void end_frame() {
+        const std::lock_guard lock(m_mutex);
+        m_frame_micros.add(m_current.micros);
+        ++m_frames;
+        m_last    = m_current;
+        m_current = frame_t{};
+    }
+
+    /**
+     * @brief The frame closed by the last end_frame().
+     */
+    frame_t last_frame() const {
+        const std::lock_guard lock(m_mutex);
+        return m_last;
+    }
+
+    /**
+     * @brief Microseconds spent pathing per frame, over every frame.
+     */
+    path_stats_histogram_t frame_micros() const {
+        const std::lock_guard lock(m_mutex);
+        return m_frame_micros;
+    }
+
+    size_t frame_count() const {
+        const std::lock_guard lock(m_mutex);
+        return m_frames;
+    }
+
+    void clear() {
+        const std::lock_guard lock(m_mutex);
+        m_current = frame_t{};
+        m_last    = frame_t{};
+        m_frame_micros.clear();
+        m_frames = 0;
+    }
+};
+
+/**
+ * @brief Sends the stats of every following search to @p collector, nullptr
+ * to stop. The collector must outlive its use.
+ */
+void set_path_stats_collector(path_stats_collector_t* collector) noexcept;
+
+path_stats_collector_t* get_path_stats_collector() noexcept;
+
+}  // namespace radl
@@ -0,0 +1,111 @@
+/*
+ * Monotone radix heap: a priority queue for searches whose popped keys never
+ * decrease (Dijkstra, A* with a consistent heuristic). Push is O(1) and each
+ * element moves between buckets at most 32 times, with no comparisons between
+ * elements.
+ *
+ * Keys are unsigned 32 bits, non negative floats can be used through
+ * float_key() as their bit patterns sort the same way.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace radl {
+
+template <typename value_t>
+class radix_heap_t {
+public:
+    using entry_t = std::pair<uint32_t, value_t>;
+
+private:
+    // bucket 0 holds keys equal to m_last, bucket i keys whose highest bit
+    // differing from m_last is i - 1
+    std::array<std::vector<entry_t>, 33> m_buckets;
+    uint32_t m_last = 0;
+    size_t m_size   = 0;
+
+    static inline int bucket_of(const uint32_t key,
+                                const uint32_t last) noexcept {
+        return 32 - std::countl_zero(key ^ last);
+    }
+
+public:
+    /**
+     * @brief Key of a non negative float, ordered like the float.
+     */
+    static inline uint32_t float_key(const float value) noexcept {
+        return std::bit_cast<uint32_t>(value);
+    }
+
+    inline bool empty() const noexcept {
+        return m_size == 0;
+    }
+
+    inline size_t size() const noexcept {
+        return m_size;
+    }
+
+    /**
+     * @brief The last popped key, no key lower than it may be pushed.
+     */
+    inline uint32_t last_key() const noexcept {
+        return m_last;
+    }
+
+    /**
+     * @brief Empties the heap, the buckets keep their memory.
+     */
+    inline void clear() noexcept {
+        for(auto& bucket : m_buckets) {
+            bucket.clear();
+        }
+        m_last = 0;
+        m_size = 0;
+    }
+
+    inline void push(const uint32_t key, const value_t& value) {
+        assert(key >= m_last);
+        m_buckets[bucket_of(key, m_last)].emplace_back(key, value);
+        ++m_size;
+    }
+
+    /**
+     * @brief Removes an entry with the lowest key, the heap must not be empty.
+     */
+    entry_t pop() {
+        assert(m_size > 0);
+        if(m_buckets[0].empty()) {
+            // the lowest key is in the first non empty bucket, every entry of
+            // that bucket moves to a lower one relative to it
+            size_t index = 1;
+            while(m_buckets[index].empty()) {
+                ++index;
+            }
+            auto& bucket = m_buckets[index];
+            uint32_t min = bucket.front().first;
+            for(const auto& entry : bucket) {
+                min = std::min(min, entry.first);
+            }
+            m_last = min;
+            for(const auto& entry : bucket) {
+                m_buckets[bucket_of(entry.first, m_last)].push_back(entry);
+            }
+            bucket.clear();
+        }
+        entry_t entry = std::move(m_buckets[0].back());
+        m_buckets[0].pop_back();
+        --m_size;
+        return entry;
+    }
+};
+
+}  // namespace radl
@@ -35,6 +35,10 @@ void init_common(const T &config, bool use_root_console = false) {
   InitWindow(config.width, config.height, config.window_title.c_str());
   main_detail::shader_mask =
       LoadShader(nullptr, "./resources/shaders/mask.frag");
+  register_shader("./resources/shaders/terminal_instanced.vs",
+                  "./resources/shaders/terminal_instanced.fs",
+                  "terminal_instanced");
+  register_shader("", "./resources/shaders/terminal_gpu.fs", "terminal_gpu");
   // Register fonts after OpenGL init (InitWindow), and then resize the window
   // accordingly
   RegisterFonts(config.font_path);
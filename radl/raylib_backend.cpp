@@ -0,0 +1,148 @@
+#include "raylib_backend.hpp"
+
+#include <stdexcept>
+
+#include "texture_resources.hpp"
+
+namespace radl {
+
+namespace {
+
+Texture2D to_texture(const texture_ref_t& texture) {
+    return Texture2D{texture.id, texture.width, texture.height, 1,
+                     PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+}
+
+BlendMode to_blend_mode(const blend_t blend) {
+    switch(blend) {
+    case blend_t::subtract_colors:
+        return BLEND_SUBTRACT_COLORS;
+    case blend_t::alpha:
+    default:
+        return BLEND_ALPHA;
+    }
+}
+
+}  // namespace
+
+raylib_backend::~raylib_backend() {
+    for(auto& [id, target] : m_targets) {
+        UnloadRenderTexture(target);
+    }
+}
+
+texture_ref_t raylib_backend::load_texture(const int width, const int height,
+                                           const color_t* pixels) {
+    const Image image{
+        const_cast<color_t*>(pixels), width, height, 1,
+        PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+    const auto texture = LoadTextureFromImage(image);
+    if(texture.id == 0) {
+        throw std::runtime_error("Unable to create texture");
+    }
+    return texture_ref_t{texture.id, texture.width, texture.height};
+}
+
+void raylib_backend::update_texture(const texture_ref_t& texture,
+                                    const color_t* pixels) {
+    UpdateTexture(to_texture(texture), pixels);
+}
+
+void raylib_backend::unload_texture(const texture_ref_t& texture) {
+    // checks if texture is valid is done internal to raylib
+    UnloadTexture(to_texture(texture));
+}
+
+texture_ref_t raylib_backend::font_texture(const bitmap_font& font) {
+    const auto texture = get_texture(font.texture_tag);
+    return texture_ref_t{texture.id, texture.width, texture.height};
+}
+
+target_id_t raylib_backend::load_target(const int width, const int height) {
+    const auto target = LoadRenderTexture(width, height);
+    if(target.id == 0) {
+        throw std::runtime_error("Unable to create Framebuffer object");
+    }
+    m_targets.emplace(target.id, target);
+    return target.id;
+}
+
+void raylib_backend::unload_target(const target_id_t target) {
+    auto finder = m_targets.find(target);
+    if(finder == m_targets.end()) {
+        return;
+    }
+    UnloadRenderTexture(finder->second);
+    m_targets.erase(finder);
+}
+
+void raylib_backend::begin_target(const target_id_t target) {
+    BeginTextureMode(render_texture(target));
+}
+
+void raylib_backend::end_target() {
+    EndTextureMode();
+}
+
+void raylib_backend::clear(const color_t& color) {
+    ClearBackground(color);
+}
+
+void raylib_backend::draw_quads(const texture_ref_t& texture,
+                                std::span<const quad_t> quads,
+                                const blend_t blend) {
+    if(quads.empty()) {
+        return;
+    }
+    // raylib batches consecutive quads of the same texture into one draw call
+    BeginBlendMode(to_blend_mode(blend));
+    if(texture.id == 0) {
+        for(const auto& quad : quads) {
+            DrawRectangleRec(quad.dest, quad.tint);
+        }
+    } else {
+        const auto tex = to_texture(texture);
+        for(const auto& quad : quads) {
+            DrawTexturePro(tex, quad.source, quad.dest, Vector2{0.f, 0.f}, 0.f,
+                           quad.tint);
+        }
+    }
+    EndBlendMode();
+}
+
+void raylib_backend::present(const target_id_t target, const Vector2 position,
+                             const bool yflipped, const color_t& tint) {
+    const auto& texture = render_texture(target).texture;
+    // NOTE: Render texture must be y-flipped due to default OpenGL
+    // coordinates (left-bottom)
+    auto src_rect = Rectangle{
+        0.f,
+        0.f,
+        static_cast<float>(texture.width),
+        static_cast<float>(-texture.height),
+    };
+    if(yflipped) {
+        src_rect.height *= -1;
+    }
+    DrawTextureRec(texture, src_rect, position, tint);
+}
+
+RenderTexture2D& raylib_backend::render_texture(const target_id_t target) {
+    auto finder = m_targets.find(target);
+    if(finder == m_targets.end()) {
+        throw std::runtime_error("Unknown render target: "
+                                 + std::to_string(target));
+    }
+    return finder->second;
+}
+
+raylib_backend& get_raylib_backend() {
+    auto* backend = dynamic_cast<raylib_backend*>(&get_render_backend());
+    if(backend == nullptr) {
+        throw std::runtime_error("This needs the raylib render backend");
+    }
+    return *backend;
+}
+
+}  // namespace radl
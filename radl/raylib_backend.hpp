@@ -0,0 +1,64 @@
+/*
+ * render_backend on top of raylib, the default backend.
+ */
+
+#pragma once
+
+#include <unordered_map>
+
+#include "render_backend.hpp"
+
+namespace radl {
+
+class raylib_backend final : public render_backend {
+private:
+    std::unordered_map<target_id_t, RenderTexture2D> m_targets;
+
+public:
+    raylib_backend() = default;
+
+    raylib_backend(const raylib_backend&)            = delete;
+    raylib_backend& operator=(const raylib_backend&) = delete;
+
+    ~raylib_backend() override;
+
+    texture_ref_t load_texture(int width, int height,
+                               const color_t* pixels) override;
+
+    void update_texture(const texture_ref_t& texture,
+                        const color_t* pixels) override;
+
+    void unload_texture(const texture_ref_t& texture) override;
+
+    texture_ref_t font_texture(const bitmap_font& font) override;
+
+    target_id_t load_target(int width, int height) override;
+
+    void unload_target(target_id_t target) override;
+
+    void begin_target(target_id_t target) override;
+
+    void end_target() override;
+
+    void clear(const color_t& color) override;
+
+    void draw_quads(const texture_ref_t& texture,
+                    std::span<const quad_t> quads, blend_t blend) override;
+
+    void present(target_id_t target, Vector2 position, bool yflipped,
+                 const color_t& tint) override;
+
+    /**
+     * @brief The raylib render texture of @p target, for the code paths that
+     * talk to raylib/rlgl directly.
+     */
+    RenderTexture2D& render_texture(target_id_t target);
+};
+
+/**
+ * @brief The current backend as a raylib_backend, throws if it is another
+ * backend.
+ */
+raylib_backend& get_raylib_backend();
+
+}  // namespace radl
@@ -0,0 +1,89 @@
+#include "recording_backend.hpp"
+
+namespace radl {
+
+void recording_backend::record(const command_t& command) {
+    if(m_record) {
+        m_commands.push_back(command);
+    }
+}
+
+texture_ref_t recording_backend::load_texture(const int width,
+                                              const int height,
+                                              const color_t*) {
+    const texture_ref_t texture{m_next_id++, width, height};
+    ++m_stats.texture_uploads;
+    m_stats.upload_bytes += static_cast<size_t>(width) * height * 4;
+    record(command_t{command_type_t::load_texture, texture.id});
+    return texture;
+}
+
+void recording_backend::update_texture(const texture_ref_t& texture,
+                                       const color_t*) {
+    ++m_stats.texture_uploads;
+    m_stats.upload_bytes += static_cast<size_t>(texture.width) * texture.height
+                            * 4;
+    record(command_t{command_type_t::update_texture, texture.id});
+}
+
+void recording_backend::unload_texture(const texture_ref_t& texture) {
+    record(command_t{command_type_t::unload_texture, texture.id});
+}
+
+texture_ref_t recording_backend::font_texture(const bitmap_font& font) {
+    auto finder = m_font_textures.find(font.texture_tag);
+    if(finder != m_font_textures.end()) {
+        return finder->second;
+    }
+    // CP437 fonts are a grid of 16x16 glyphs
+    const auto& [fwidth, fheight] = font.character_size;
+    const texture_ref_t texture{m_next_id++, 16 * fwidth, 16 * fheight};
+    return m_font_textures.emplace(font.texture_tag, texture).first->second;
+}
+
+target_id_t recording_backend::load_target(const int, const int) {
+    const target_id_t target = m_next_id++;
+    record(command_t{command_type_t::load_target, target});
+    return target;
+}
+
+void recording_backend::unload_target(const target_id_t target) {
+    record(command_t{command_type_t::unload_target, target});
+}
+
+void recording_backend::begin_target(const target_id_t target) {
+    ++m_stats.target_binds;
+    record(command_t{command_type_t::begin_target, target});
+}
+
+void recording_backend::end_target() {
+    record(command_t{command_type_t::end_target});
+}
+
+void recording_backend::clear(const color_t&) {
+    ++m_stats.clears;
+    record(command_t{command_type_t::clear});
+}
+
+void recording_backend::draw_quads(const texture_ref_t& texture,
+                                   std::span<const quad_t> quads,
+                                   const blend_t blend) {
+    if(quads.empty()) {
+        return;
+    }
+    ++m_stats.draw_calls;
+    m_stats.quads += quads.size();
+    if(m_record) {
+        m_commands.push_back(command_t{command_type_t::draw_quads, texture.id,
+                                       blend, m_quads.size(), quads.size()});
+        m_quads.insert(m_quads.end(), quads.begin(), quads.end());
+    }
+}
+
+void recording_backend::present(const target_id_t target, const Vector2,
+                                const bool, const color_t&) {
+    ++m_stats.presents;
+    record(command_t{command_type_t::present, target});
+}
+
+}  // namespace radl
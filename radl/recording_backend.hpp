@@ -0,0 +1,120 @@
+/*
+ * render_backend that draws nothing: it only counts (and optionally records)
+ * the commands it receives. No window or GL context is needed, so the
+ * simulation and the cell to quad pipeline can be profiled and load tested
+ * on their own.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "render_backend.hpp"
+
+namespace radl {
+
+class recording_backend final : public render_backend {
+public:
+    enum class command_type_t {
+        load_texture,
+        update_texture,
+        unload_texture,
+        load_target,
+        unload_target,
+        begin_target,
+        end_target,
+        clear,
+        draw_quads,
+        present,
+    };
+
+    struct command_t {
+        command_type_t type;
+        // texture or target id
+        uint32_t id = 0;
+        // draw_quads: the quads are quads()[first_quad, first_quad + count)
+        blend_t blend     = blend_t::alpha;
+        size_t first_quad = 0;
+        size_t count      = 0;
+    };
+
+    struct stats_t {
+        size_t draw_calls      = 0;
+        size_t quads           = 0;
+        size_t texture_uploads = 0;
+        size_t upload_bytes    = 0;
+        size_t target_binds    = 0;
+        size_t clears          = 0;
+        size_t presents        = 0;
+    };
+
+private:
+    bool m_record;
+    stats_t m_stats;
+    std::vector<command_t> m_commands;
+    std::vector<quad_t> m_quads;
+    uint32_t m_next_id = 1;
+    std::unordered_map<std::string, texture_ref_t> m_font_textures;
+
+    void record(const command_t& command);
+
+public:
+    /**
+     * @param record_commands if false only the stats are kept (a null
+     * backend)
+     */
+    explicit recording_backend(bool record_commands = true)
+        : m_record(record_commands) {}
+
+    texture_ref_t load_texture(int width, int height,
+                               const color_t* pixels) override;
+
+    void update_texture(const texture_ref_t& texture,
+                        const color_t* pixels) override;
+
+    void unload_texture(const texture_ref_t& texture) override;
+
+    texture_ref_t font_texture(const bitmap_font& font) override;
+
+    target_id_t load_target(int width, int height) override;
+
+    void unload_target(target_id_t target) override;
+
+    void begin_target(target_id_t target) override;
+
+    void end_target() override;
+
+    void clear(const color_t& color) override;
+
+    void draw_quads(const texture_ref_t& texture,
+                    std::span<const quad_t> quads, blend_t blend) override;
+
+    void present(target_id_t target, Vector2 position, bool yflipped,
+                 const color_t& tint) override;
+
+    inline const stats_t& stats() const noexcept {
+        return m_stats;
+    }
+
+    inline const std::vector<command_t>& commands() const noexcept {
+        return m_commands;
+    }
+
+    inline const std::vector<quad_t>& quads() const noexcept {
+        return m_quads;
+    }
+
+    /**
+     * @brief Forgets the recorded commands and zeroes the stats, e.g. once per
+     * frame. Textures and targets stay valid.
+     */
+    inline void reset() {
+        m_stats = stats_t{};
+        m_commands.clear();
+        m_quads.clear();
+    }
+};
+
+}  // namespace radl
@@ -0,0 +1,288 @@
+/*
+ * Connected regions of the walkable tiles of a grid, so a path finder can
+ * tell in O(1) that a goal cannot be reached instead of searching until it
+ * runs out of steps.
+ *
+ * build() labels the map with flood fills. Every label is an entry of a
+ * union-find forest, the region of a tile is the root of its label:
+ * update_tile() on a tile made walkable merges the regions around it, a tile
+ * made a wall may split its region, so the pieces around it are flood filled
+ * again. Neighbours are the 8 (or 4 without diagonal_moves) tiles around, so
+ * a region never separates tiles a path finder could link.
+ *
+ * Queries are const and write nothing, so path_find_batch workers can share a
+ * map through is_reachable. build() and update_tile() must not run during
+ * them.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "grid_path_finding.hpp"
+
+namespace radl {
+
+template <typename location_t, typename navigator_t>
+    requires grid_navigator<navigator_t, location_t>
+class region_map_t {
+public:
+    static constexpr int no_region = -1;
+
+private:
+    static constexpr bool diagonal  = grid_diagonal_moves<navigator_t>();
+    static constexpr int directions = diagonal ? 8 : 4;
+
+    int m_width  = 0;
+    int m_height = 0;
+    // label of each tile, no_region for walls
+    std::vector<int> m_labels;
+    // union-find forest over the labels, and the size of each tree
+    std::vector<int> m_parent;
+    std::vector<int> m_size;
+    // tiles made walls, to refill around
+    std::vector<int> m_split;
+    bool m_built = false;
+    // flood fill, stamped so nothing is cleared between fills
+    std::vector<uint32_t> m_visited;
+    uint32_t m_generation = 0;
+    std::vector<int> m_stack;
+
+    static inline bool walkable(const int x, const int y) {
+        return navigator_t::is_walkable(navigator_t::get_xy(x, y));
+    }
+
+    inline bool inside(const int x, const int y) const noexcept {
+        return x >= 0 && y >= 0 && x < m_width && y < m_height;
+    }
+
+    void next_generation() {
+        if(++m_generation == 0) {
+            std::fill(m_visited.begin(), m_visited.end(), 0);
+            m_generation = 1;
+        }
+    }
+
+    inline int new_label() {
+        m_parent.push_back(static_cast<int>(m_parent.size()));
+        m_size.push_back(1);
+        return m_parent.back();
+    }
+
+    // Root of @p label, halving the path on the way
+    inline int find(int label) noexcept {
+        while(m_parent[label] != label) {
+            m_parent[label] = m_parent[m_parent[label]];
+            label           = m_parent[label];
+        }
+        return label;
+    }
+
+    // find() for the queries, leaves the forest as it is
+    inline int root(int label) const noexcept {
+        while(m_parent[label] != label) {
+            label = m_parent[label];
+        }
+        return label;
+    }
+
+    inline int unite(int a, int b) noexcept {
+        a = find(a);
+        b = find(b);
+        if(a == b) {
+            return a;
+        }
+        if(m_size[a] < m_size[b]) {
+            std::swap(a, b);
+        }
+        m_parent[b] = a;
+        m_size[a] += m_size[b];
+        return a;
+    }
+
+    // Gives @p label to every tile reachable from @p seed whose region is
+    // @p region (any walkable tile, for no_region)
+    void fill(const int seed, const int region, const int label) {
+        m_stack.clear();
+        m_stack.push_back(seed);
+        m_visited[seed] = m_generation;
+        while(!m_stack.empty()) {
+            const int cell = m_stack.back();
+            m_stack.pop_back();
+            m_labels[cell] = label;
+            const int x    = cell % m_width;
+            const int y    = cell / m_width;
+            for(int d = 0; d < directions; ++d) {
+                const int nx = x + grid_dx[d];
+                const int ny = y + grid_dy[d];
+                if(!inside(nx, ny)) {
+                    continue;
+                }
+                const int next = ny * m_width + nx;
+                if(m_visited[next] == m_generation
+                   || m_labels[next] == no_region
+                   || (region != no_region
+                       && find(m_labels[next]) != region)) {
+                    continue;
+                }
+                m_visited[next] = m_generation;
+                m_stack.push_back(next);
+            }
+        }
+    }
+
+    // Flood fills the pieces around the tiles made walls, each with a label
+    // of its own
+    void refill() {
+        // splits leave stale labels behind, start over once they outnumber
+        // the tiles
+        if(m_parent.size() > m_labels.size() * 2) {
+            build();
+            return;
+        }
+        next_generation();
+        for(const int wall : m_split) {
+            const int x = wall % m_width;
+            const int y = wall / m_width;
+            for(int d = -1; d < directions; ++d) {
+                const int nx = d < 0 ? x : x + grid_dx[d];
+                const int ny = d < 0 ? y : y + grid_dy[d];
+                if(!inside(nx, ny)) {
+                    continue;
+                }
+                const int seed = ny * m_width + nx;
+                if(m_labels[seed] == no_region
+                   || m_visited[seed] == m_generation) {
+                    continue;
+                }
+                const int region = find(m_labels[seed]);
+                const int label  = new_label();
+                fill(seed, region, label);
+            }
+        }
+        m_split.clear();
+    }
+
+public:
+    region_map_t(const int width, const int height) {
+        resize(width, height);
+    }
+
+    /**
+     * @brief Resizes the map, to build() again.
+     */
+    void resize(const int width, const int height) {
+        m_width  = width;
+        m_height = height;
+        m_labels.assign(static_cast<size_t>(width) * height, no_region);
+        m_visited.assign(m_labels.size(), 0);
+        m_generation = 0;
+        m_parent.clear();
+        m_size.clear();
+        m_split.clear();
+        m_built = false;
+    }
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    /**
+     * @brief Labels the whole map from the navigator's walkability, O(tiles).
+     * Call it once the map is set up, and after changing many tiles at once.
+     */
+    void build() {
+        m_parent.clear();
+        m_size.clear();
+        m_split.clear();
+        for(int y = 0; y < m_height; ++y) {
+            for(int x = 0; x < m_width; ++x) {
+                m_labels[y * m_width + x] = walkable(x, y) ? 0 : no_region;
+            }
+        }
+        next_generation();
+        for(int cell = 0; cell < static_cast<int>(m_labels.size()); ++cell) {
+            if(m_labels[cell] != no_region
+               && m_visited[cell] != m_generation) {
+                fill(cell, no_region, new_label());
+            }
+        }
+        m_built = true;
+    }
+
+    /**
+     * @brief Reads the walkability of x/y again after it changed. A tile made
+     * walkable joins the regions around it, one made a wall flood fills the
+     * pieces its region may have split into. Off-map tiles are ignored.
+     */
+    void update_tile(const int x, const int y) {
+        if(!m_built || !inside(x, y)) {
+            return;
+        }
+        const int cell = y * m_width + x;
+        if(!walkable(x, y)) {
+            if(m_labels[cell] != no_region) {
+                m_labels[cell] = no_region;
+                m_split.push_back(cell);
+                refill();
+            }
+            return;
+        }
+        if(m_labels[cell] != no_region) {
+            return;
+        }
+        int label = no_region;
+        for(int d = 0; d < directions; ++d) {
+            const int nx = x + grid_dx[d];
+            const int ny = y + grid_dy[d];
+            if(!inside(nx, ny) || m_labels[ny * m_width + nx] == no_region) {
+                continue;
+            }
+            const int other = m_labels[ny * m_width + nx];
+            label           = label == no_region ? other : unite(label, other);
+        }
+        m_labels[cell] = label == no_region ? new_label() : label;
+    }
+
+    inline bool built() const noexcept {
+        return m_built;
+    }
+
+    /**
+     * @brief Region of x/y, no_region for walls, tiles off the map and before
+     * build(). Tiles have the same region if and only if a path links them.
+     */
+    int region(const int x, const int y) const {
+        if(!m_built || !inside(x, y)) {
+            return no_region;
+        }
+        const int label = m_labels[y * m_width + x];
+        return label == no_region ? no_region : root(label);
+    }
+
+    inline int region(const location_t& loc) const {
+        return region(navigator_t::get_x(loc), navigator_t::get_y(loc));
+    }
+
+    /**
+     * @brief True if a path could link @p from and @p to, both walkable.
+     * Always true before build(), nothing is known yet.
+     */
+    bool connected(const location_t& from, const location_t& to) const {
+        if(!m_built) {
+            return true;
+        }
+        const int a = region(from);
+        return a != no_region && a == region(to);
+    }
+};
+
+}  // namespace radl
@@ -0,0 +1,24 @@
+#include "render_backend.hpp"
+
+#include "raylib_backend.hpp"
+
+namespace radl {
+
+namespace backend_detail {
+
+std::unique_ptr<render_backend> backend;
+
+}  // namespace backend_detail
+
+render_backend& get_render_backend() {
+    if(!backend_detail::backend) {
+        backend_detail::backend = std::make_unique<raylib_backend>();
+    }
+    return *backend_detail::backend;
+}
+
+void set_render_backend(std::unique_ptr<render_backend> backend) {
+    backend_detail::backend = std::move(backend);
+}
+
+}  // namespace radl
@@ -0,0 +1,156 @@
+/*
+ * Render backend interface: everything the terminals and the GUI need from the
+ * graphics API (texture upload, render targets, batched quads and presenting
+ * targets on screen). The raylib_backend is the default, the
+ * recording_backend needs no GL context and is meant for profiling and load
+ * tests.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "color_t.hpp"
+#include "font_manager.hpp"
+#include "raylib.h"
+
+namespace radl {
+
+/*
+ * A texture owned by a backend, passed around by value.
+ */
+struct texture_ref_t {
+    uint32_t id = 0;
+    int width   = 0;
+    int height  = 0;
+};
+
+using target_id_t = uint32_t;
+
+enum class blend_t {
+    // Straight alpha blending
+    alpha,
+    // dst = src - dst, drawing BLANK clears what is under the quad
+    subtract_colors,
+};
+
+/*
+ * A quad drawn from @p source (in texture pixels) to @p dest, tinted.
+ * Untextured quads are filled with the tint.
+ */
+struct quad_t {
+    Rectangle source;
+    Rectangle dest;
+    color_t tint;
+};
+
+class render_backend {
+public:
+    virtual ~render_backend() = default;
+
+    /**
+     * @brief Uploads a @p width x @p height RGBA8 texture.
+     */
+    virtual texture_ref_t load_texture(int width, int height,
+                                       const color_t* pixels)
+        = 0;
+
+    /**
+     * @brief Replaces the whole contents of @p texture.
+     */
+    virtual void update_texture(const texture_ref_t& texture,
+                                const color_t* pixels)
+        = 0;
+
+    virtual void unload_texture(const texture_ref_t& texture) = 0;
+
+    /**
+     * @brief The texture holding the glyphs of @p font.
+     */
+    virtual texture_ref_t font_texture(const bitmap_font& font) = 0;
+
+    virtual target_id_t load_target(int width, int height) = 0;
+
+    virtual void unload_target(target_id_t target) = 0;
+
+    /**
+     * @brief Redirects the following clear/draw_quads calls to @p target,
+     * until end_target.
+     */
+    virtual void begin_target(target_id_t target) = 0;
+
+    virtual void end_target() = 0;
+
+    virtual void clear(const color_t& color) = 0;
+
+    /**
+     * @brief Draws @p quads in one batch.
+     *
+     * @param texture source texture, untextured quads when its id is 0
+     */
+    virtual void draw_quads(const texture_ref_t& texture,
+                            std::span<const quad_t> quads, blend_t blend)
+        = 0;
+
+    /**
+     * @brief Draws @p target to the screen (or the active target) at
+     * @p position.
+     *
+     * @param yflipped if true the target is drawn upside down
+     */
+    virtual void present(target_id_t target, Vector2 position, bool yflipped,
+                         const color_t& tint)
+        = 0;
+};
+
+/**
+ * @brief The backend used by terminals and the GUI, a raylib_backend unless
+ * another one was set.
+ */
+render_backend& get_render_backend();
+
+/**
+ * @brief Replaces the render backend. Do it before creating any terminal, the
+ * targets and textures of a backend can't outlive it.
+ */
+void set_render_backend(std::unique_ptr<render_backend> backend);
+
+/**
+ * @brief RAII render target of the current backend.
+ */
+class render_target_t {
+private:
+    render_backend* m_backend;
+    target_id_t m_id;
+
+public:
+    render_target_t(const int width, const int height)
+        : m_backend(&get_render_backend())
+        , m_id(m_backend->load_target(width, height)) {}
+
+    render_target_t(const render_target_t&)            = delete;
+    render_target_t& operator=(const render_target_t&) = delete;
+
+    ~render_target_t() {
+        m_backend->unload_target(m_id);
+    }
+
+    inline target_id_t id() const noexcept {
+        return m_id;
+    }
+
+    /**
+     * @brief Clears the target
+     *
+     * @param color optional color to clear the target
+     */
+    inline void clear(const color_t& color = BLANK) {
+        m_backend->begin_target(m_id);
+        m_backend->clear(color);
+        m_backend->end_target();
+    }
+};
+
+}  // namespace radl
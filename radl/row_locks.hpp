@@ -0,0 +1,95 @@
+/*
+ * One mutex per row of a grid, so writers of disjoint row bands never contend.
+ * Bands are always locked in ascending row order, which keeps concurrent
+ * multi-row writers deadlock free.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace radl {
+
+class row_locks_t {
+private:
+    std::unique_ptr<std::mutex[]> m_locks;
+    int m_rows         = 0;
+    bool m_thread_safe = true;
+
+public:
+    /**
+     * @brief Holds the locks of a band of rows until destroyed.
+     */
+    class guard_t {
+    private:
+        std::mutex* m_first = nullptr;
+        int m_count         = 0;
+
+    public:
+        guard_t() = default;
+
+        guard_t(std::mutex* first, const int count)
+            : m_first(first)
+            , m_count(count) {
+            for(int i = 0; i < m_count; ++i) {
+                m_first[i].lock();
+            }
+        }
+
+        guard_t(guard_t&& rhs) noexcept
+            : m_first(std::exchange(rhs.m_first, nullptr))
+            , m_count(std::exchange(rhs.m_count, 0)) {}
+
+        guard_t(const guard_t&)            = delete;
+        guard_t& operator=(const guard_t&) = delete;
+        guard_t& operator=(guard_t&&)      = delete;
+
+        ~guard_t() {
+            for(int i = m_count - 1; i >= 0; --i) {
+                m_first[i].unlock();
+            }
+        }
+    };
+
+    inline void resize(const int rows) {
+        m_rows  = rows;
+        m_locks = std::make_unique<std::mutex[]>(rows);
+    }
+
+    /**
+     * @brief When false, the terminal has a single owner thread and locking is
+     * skipped altogether.
+     */
+    inline void set_thread_safe(const bool thread_safe) noexcept {
+        m_thread_safe = thread_safe;
+    }
+
+    inline bool thread_safe() const noexcept {
+        return m_thread_safe;
+    }
+
+    /**
+     * @brief Locks the rows [y0, y1), clipped to the grid.
+     */
+    [[nodiscard]] inline guard_t lock(int y0, int y1) {
+        y0 = std::max(y0, 0);
+        y1 = std::min(y1, m_rows);
+        if(!m_thread_safe || y0 >= y1) {
+            return guard_t{};
+        }
+        return guard_t{&m_locks[y0], y1 - y0};
+    }
+
+    [[nodiscard]] inline guard_t lock_row(const int y) {
+        return lock(y, y + 1);
+    }
+
+    [[nodiscard]] inline guard_t lock_all() {
+        return lock(0, m_rows);
+    }
+};
+
+}  // namespace radl
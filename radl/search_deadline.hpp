@@ -0,0 +1,44 @@
+/*
+ * Time budget of the searches that can be stepped and resumed
+ * (path_request_t, ara_search_t). Reading the clock costs about as much as an
+ * expansion, so expired() only looks at it every few calls.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace radl {
+
+class search_deadline_t {
+private:
+    static constexpr size_t clock_interval = 16;
+
+    std::chrono::steady_clock::time_point m_until;
+    size_t m_count = 0;
+    bool m_timed   = false;
+
+public:
+    /**
+     * @brief No time limit, expired() is always false.
+     */
+    search_deadline_t() = default;
+
+    explicit search_deadline_t(const std::chrono::microseconds budget)
+        : m_until(std::chrono::steady_clock::now() + budget),
+          m_timed(true) {}
+
+    /**
+     * @brief Call once per expansion: true once the budget is spent.
+     */
+    inline bool expired() noexcept {
+        if(!m_timed || ++m_count < clock_interval) {
+            return false;
+        }
+        m_count = 0;
+        return std::chrono::steady_clock::now() >= m_until;
+    }
+};
+
+}  // namespace radl
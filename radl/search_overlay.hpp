@@ -0,0 +1,61 @@
+/*
+ * Search visualisation: paints the nodes a search opened and expanded over a
+ * virtual terminal, to see why a search was slow (a heuristic leading it into
+ * a dead end, a goal behind a wall...). Give a search of your own a trace to
+ * fill and run it with path_find_into:
+ *
+ *   using search_t = AStarSearch<search_node_t<location_t, navigator>>;
+ *   search_t search;
+ *   search_t::SearchTrace trace;
+ *   search.SetTrace(&trace);
+ *   path_find_into<navigator>(search, start, end, path);
+ *   paint_search_overlay<navigator>(vterm, trace);
+ *
+ * Only the background of the cells changes, the glyphs drawn below stay
+ * readable. Nothing is recorded without a trace, so the hook stays in
+ * production builds.
+ */
+
+#pragma once
+
+#include "virtual_terminal.hpp"
+
+namespace radl {
+
+/*
+ * Background colors of the overlay cells. In palette mode (see
+ * virtual_terminal::set_palette) they must be in the palette.
+ */
+struct search_overlay_style_t {
+    color_t opened   = colors::DARK_GREEN;
+    color_t expanded = colors::DARKER_RED;
+};
+
+/**
+ * @brief Paints the nodes of @p trace (a SearchTrace) on @p vterm: the open
+ * ones, then the expanded ones over them. Positions outside the terminal are
+ * skipped. The navigator needs get_x and get_y, like the grid path finders.
+ */
+template <typename navigator_t, typename trace_t>
+void paint_search_overlay(virtual_terminal& vterm, const trace_t& trace,
+                          const search_overlay_style_t& style = {}) {
+    auto writer = vterm.writer();
+    auto paint  = [&](const auto& states, const color_t& background) {
+        for(const auto& state : states) {
+            const int x = navigator_t::get_x(state.pos);
+            const int y = navigator_t::get_y(state.pos);
+            if(x < 0 || y < 0 || x >= vterm.term_width
+               || y >= vterm.term_height) {
+                continue;
+            }
+            vchar_t cell    = vterm.get_char(x, y);
+            cell.background = background;
+            writer.set_char(x, y, cell);
+        }
+    };
+    paint(trace.opened, style.opened);
+    paint(trace.expanded, style.expanded);
+    vterm.dirty = true;
+}
+
+}  // namespace radl
@@ -0,0 +1,231 @@
+#include "software_rasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "gui.hpp"
+#include "virtual_terminal.hpp"
+#include "virtual_terminal_sparse.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define RADL_RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace radl {
+
+namespace {
+
+// x / 255 rounded to nearest, exact for x <= 255 * 255
+inline uint32_t div255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+inline color_t modulate(const color_t& a, const color_t& b) {
+    return color_t{
+        static_cast<uint8_t>(div255(a.r * b.r)),
+        static_cast<uint8_t>(div255(a.g * b.g)),
+        static_cast<uint8_t>(div255(a.b * b.b)),
+        static_cast<uint8_t>(div255(a.a * b.a)),
+    };
+}
+
+/*
+ * Blends @p count pixels of @p src, modulated by @p tint, over @p dst (straight
+ * alpha). The SIMD and scalar paths give the exact same results, so images are
+ * comparable across machines.
+ */
+void blend_span_scalar(color_t* dst, const color_t* src, const int count,
+                       const color_t& tint) {
+    for(int i = 0; i < count; ++i) {
+        const color_t s   = modulate(src[i], tint);
+        const uint32_t a  = s.a;
+        const uint32_t ia = 255 - a;
+        color_t& d        = dst[i];
+        d.r               = static_cast<uint8_t>(div255(s.r * a + d.r * ia));
+        d.g               = static_cast<uint8_t>(div255(s.g * a + d.g * ia));
+        d.b               = static_cast<uint8_t>(div255(s.b * a + d.b * ia));
+        d.a               = static_cast<uint8_t>(div255(255 * a + d.a * ia));
+    }
+}
+
+#if defined(RADL_RASTER_SSE2)
+inline __m128i div255_epi16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// Two pixels, one 16-bit lane per channel
+inline __m128i blend_pixels(__m128i s, const __m128i d, const __m128i tint) {
+    const __m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    s                         = div255_epi16(_mm_mullo_epi16(s, tint));
+    const __m128i a           = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(s, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(3, 3, 3, 3));
+    const __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    // alpha lanes become 255, so out.a = a + d.a * (1 - a)
+    s = _mm_or_si128(s, alpha_lanes);
+    return div255_epi16(
+        _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, ia)));
+}
+#endif
+
+void blend_span(color_t* dst, const color_t* src, const int count,
+                const color_t& tint) {
+    int i = 0;
+#if defined(RADL_RASTER_SSE2)
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i tint2 = _mm_set_epi16(tint.a, tint.b, tint.g, tint.r, tint.a,
+                                        tint.b, tint.g, tint.r);
+    for(; i + 4 <= count; i += 4) {
+        const __m128i s = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(src + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i*>(dst + i));
+        const __m128i lo = blend_pixels(_mm_unpacklo_epi8(s, zero),
+                                        _mm_unpacklo_epi8(d, zero), tint2);
+        const __m128i hi = blend_pixels(_mm_unpackhi_epi8(s, zero),
+                                        _mm_unpackhi_epi8(d, zero), tint2);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+                         _mm_packus_epi16(lo, hi));
+    }
+#endif
+    blend_span_scalar(dst + i, src + i, count - i, tint);
+}
+
+}  // namespace
+
+software_rasterizer::software_rasterizer(const int width, const int height) {
+    resize(width, height);
+}
+
+void software_rasterizer::resize(const int width, const int height) {
+    m_width  = width;
+    m_height = height;
+    m_pixels.assign(static_cast<size_t>(width) * height, colors::NONE);
+}
+
+void software_rasterizer::clear(const color_t& color) {
+    std::fill(m_pixels.begin(), m_pixels.end(), color);
+}
+
+const software_rasterizer::font_image_t&
+software_rasterizer::font_image(const bitmap_font& font) {
+    auto finder = m_fonts.find(font.texture_tag);
+    if(finder != m_fonts.end()) {
+        return finder->second;
+    }
+    // Image loading is CPU only in raylib, no window needed
+    Image image = load_font_image(font);
+    font_image_t font_pixels{image.width, image.height, {}};
+    const auto* data = static_cast<const color_t*>(image.data);
+    font_pixels.pixels.assign(data, data + image.width * image.height);
+    UnloadImage(image);
+    return m_fonts.emplace(font.texture_tag, std::move(font_pixels))
+        .first->second;
+}
+
+void software_rasterizer::draw_cell(const int px, const int py,
+                                    const clip_t& clip,
+                                    const bitmap_font& font,
+                                    const font_image_t& image,
+                                    const vchar_t& vch, const bool background,
+                                    const color_t& tint) {
+    const auto& [fwidth, fheight] = font.character_size;
+    const int x0                  = std::max({px, clip.x0, 0});
+    const int x1                  = std::min({px + fwidth, clip.x1, m_width});
+    const int y0                  = std::max({py, clip.y0, 0});
+    const int y1                  = std::min({py + fheight, clip.y1, m_height});
+    if(x0 >= x1 || y0 >= y1) {
+        return;
+    }
+    const int span = x1 - x0;
+
+    if(background && vch.background.a != 0) {
+        const color_t bg = modulate(vch.background, tint);
+        for(int y = y0; y < y1; ++y) {
+            blend_span(&m_pixels[y * m_width + x0], m_solid.data(), span, bg);
+        }
+    }
+
+    Rectangle glyph_rect{0.f, 0.f, static_cast<float>(fwidth),
+                         static_cast<float>(fheight)};
+    set_rectangle_position_from_vchar(glyph_rect, vch, font);
+    const int gx = static_cast<int>(glyph_rect.x) + (x0 - px);
+    const int gy = static_cast<int>(glyph_rect.y) + (y0 - py);
+    if(gx + span > image.width || gy + (y1 - y0) > image.height) {
+        return;  // glyph outside of the font image
+    }
+    const color_t fg = modulate(vch.foreground, tint);
+    for(int y = y0; y < y1; ++y) {
+        blend_span(&m_pixels[y * m_width + x0],
+                   &image.pixels[(gy + y - y0) * image.width + gx], span, fg);
+    }
+}
+
+void software_rasterizer::draw(const virtual_terminal& term) {
+    if(!term.visible) {
+        return;
+    }
+    const auto& font              = term.get_font();
+    const auto& image             = font_image(font);
+    const auto& [fwidth, fheight] = font.character_size;
+    const auto [ox, oy]           = term.get_offset();
+    const clip_t clip{ox, oy, ox + term.term_width * fwidth,
+                      oy + term.term_height * fheight};
+    m_solid.resize(std::max<size_t>(m_solid.size(), fwidth), colors::White);
+    for(int y = 0; y < term.term_height; ++y) {
+        for(int x = 0; x < term.term_width; ++x) {
+            draw_cell(ox + x * fwidth, oy + y * fheight, clip, font, image,
+                      term.get_drawn_char(x, y), term.has_background(),
+                      term.get_tint());
+        }
+    }
+}
+
+void software_rasterizer::draw(const virtual_terminal_sparse& term) {
+    if(!term.visible) {
+        return;
+    }
+    const auto& font              = term.get_font();
+    const auto& image             = font_image(font);
+    const auto& [fwidth, fheight] = font.character_size;
+    const auto [ox, oy]           = term.get_offset();
+    const clip_t clip{ox, oy, ox + term.term_width * fwidth,
+                      oy + term.term_height * fheight};
+    m_solid.resize(std::max<size_t>(m_solid.size(), fwidth), colors::White);
+    for(const auto& svch : term.get_chars()) {
+        const int px = ox + static_cast<int>(std::lround(svch.x * fwidth));
+        const int py = oy + static_cast<int>(std::lround(svch.y * fheight));
+        draw_cell(px, py, clip, font, image,
+                  vchar_t{svch.glyph, svch.foreground, svch.background},
+                  svch.has_background, term.get_tint());
+    }
+}
+
+void software_rasterizer::draw(gui_t& gui) {
+    gui.for_each_layer([this](layer_t& layer) {
+        if(layer.vterm) {
+            layer.render_controls();
+            draw(*layer.vterm);
+        } else if(layer.svterm) {
+            draw(*layer.svterm);
+        }
+    });
+}
+
+Image software_rasterizer::image() const {
+    return Image{
+        const_cast<color_t*>(m_pixels.data()), m_width, m_height, 1,
+        PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+    };
+}
+
+void software_rasterizer::export_image(const std::string& filename) const {
+    if(!ExportImage(image(), filename.c_str())) {
+        throw std::runtime_error("Unable to export image to: " + filename);
+    }
+}
+
+}  // namespace radl
@@ -0,0 +1,114 @@
+/*
+ * Headless CPU rasterizer: draws terminals, sparse terminals and whole GUIs
+ * into an in-memory RGBA image, with no window or GL context. Meant for
+ * server side screenshots, golden image comparisons and benchmarks.
+ *
+ * Fonts are read from their image files, register them with
+ * RegisterFonts(path, false) when there is no window.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "color_t.hpp"
+#include "colors.hpp"
+#include "font_manager.hpp"
+#include "raylib.h"
+
+namespace radl {
+
+class gui_t;
+class virtual_terminal;
+class virtual_terminal_sparse;
+
+class software_rasterizer {
+private:
+    // RGBA8 copy of a font image
+    struct font_image_t {
+        int width  = 0;
+        int height = 0;
+        std::vector<color_t> pixels;
+    };
+
+    // Pixel rectangle [x0, x1) x [y0, y1)
+    struct clip_t {
+        int x0;
+        int y0;
+        int x1;
+        int y1;
+    };
+
+    int m_width  = 0;
+    int m_height = 0;
+    std::vector<color_t> m_pixels;
+    // font texture tag -> pixels
+    std::unordered_map<std::string, font_image_t> m_fonts;
+    // Row of white pixels, the source of solid fills
+    std::vector<color_t> m_solid;
+
+    const font_image_t& font_image(const bitmap_font& font);
+
+    void draw_cell(int px, int py, const clip_t& clip, const bitmap_font& font,
+                   const font_image_t& image, const vchar_t& vch,
+                   bool background, const color_t& tint);
+
+public:
+    software_rasterizer(int width, int height);
+
+    /**
+     * @brief Resizes the canvas, its contents are cleared to transparent.
+     */
+    void resize(int width, int height);
+
+    void clear(const color_t& color = colors::Black);
+
+    /**
+     * @brief Draws @p term at its offset, the same way render() + draw() do.
+     * Nothing else may write to the terminal meanwhile.
+     */
+    void draw(const virtual_terminal& term);
+
+    void draw(const virtual_terminal_sparse& term);
+
+    /**
+     * @brief Draws every console layer of @p gui in render order, after
+     * rendering their retained mode controls. Owner draw layers need raylib
+     * and are skipped.
+     */
+    void draw(gui_t& gui);
+
+    inline int width() const noexcept {
+        return m_width;
+    }
+
+    inline int height() const noexcept {
+        return m_height;
+    }
+
+    /**
+     * @brief The canvas, row major with the first row at the top.
+     */
+    inline const color_t* pixels() const noexcept {
+        return m_pixels.data();
+    }
+
+    inline const color_t& pixel(const int x, const int y) const noexcept {
+        return m_pixels[y * m_width + x];
+    }
+
+    /**
+     * @brief A raylib image viewing the canvas (not a copy, don't unload it).
+     */
+    Image image() const;
+
+    /**
+     * @brief Saves the canvas as an image file, the format follows the
+     * extension. Throws on failure.
+     */
+    void export_image(const std::string& filename) const;
+};
+
+}  // namespace radl
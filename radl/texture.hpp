@@ -1,5 +1,5 @@
 /*
- * Provides RAII wrapper for a texture and render_texture.
+ * Provides RAII wrapper for a texture, render_texture and shader.
  */
 
 #pragma once
@@ -8,6 +8,7 @@
 #include <string>
 
 #include "raylib.h"
+#include "rlgl.h"
 
 namespace radl {
 
@@ -25,6 +26,12 @@ struct texture_t {
                                      + filename);
         }
     }
+    inline texture_t(const Image& image) {
+        texture = LoadTextureFromImage(image);
+        if(texture.id == 0) {
+            throw std::runtime_error("Unable to load texture from image");
+        }
+    }
     inline ~texture_t() {
         // checks if texture is valid is done internal to raylib
         UnloadTexture(texture);
@@ -65,6 +72,35 @@ struct render_texture_t {
     }
 };
 
+/**
+ * @brief Class wrapper to use RAII idiom
+ *
+ */
+struct shader_t {
+    Shader shader = {0};
+
+    // An empty filename selects raylib's default shader for that stage
+    inline shader_t(const std::string& vs_filename,
+                    const std::string& fs_filename) {
+        shader = LoadShader(vs_filename.empty() ? nullptr : vs_filename.c_str(),
+                            fs_filename.empty() ? nullptr : fs_filename.c_str());
+        // raylib falls back to the default shader when the files can't be
+        // loaded or compiled
+        if(shader.id == 0 || shader.id == rlGetShaderIdDefault()) {
+            throw std::runtime_error("Unable to load shader from: "
+                                     + vs_filename + ", " + fs_filename);
+        }
+    }
+
+    shader_t(const shader_t&) = delete;
+    shader_t& operator=(const shader_t&) = delete;
+
+    inline ~shader_t() {
+        // default shader is never unloaded inside raylib internals
+        UnloadShader(shader);
+    }
+};
+
 inline void texture_clear(RenderTexture2D& render_texture,
                           const Color& color = BLANK) {
     BeginTextureMode(render_texture);
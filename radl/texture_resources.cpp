@@ -16,6 +16,8 @@ bool atlas_contains_tag(const std::string& tag) {
     return itr != atlas.end();
 }
 
+std::unordered_map<std::string, radl::shader_t> shaders;
+
 }  // namespace texture_detail
 
 void register_texture(const std::string& filename, const std::string& tag) {
@@ -25,6 +27,13 @@ void register_texture(const std::string& filename, const std::string& tag) {
     texture_detail::atlas.emplace(std::make_pair(tag, filename));
 }
 
+void register_texture(const Image& image, const std::string& tag) {
+    if(texture_detail::atlas_contains_tag(tag)) {
+        throw std::runtime_error("Duplicate resource tag: " + tag);
+    }
+    texture_detail::atlas.try_emplace(tag, image);
+}
+
 Texture2D get_texture(const std::string& tag) {
     auto finder = texture_detail::atlas.find(tag);
     if(finder == texture_detail::atlas.end()) {
@@ -33,5 +42,21 @@ Texture2D get_texture(const std::string& tag) {
     return finder->second.texture;
 }
 
+void register_shader(const std::string& vs_filename,
+                     const std::string& fs_filename, const std::string& tag) {
+    if(texture_detail::shaders.contains(tag)) {
+        throw std::runtime_error("Duplicate resource tag: " + tag);
+    }
+    texture_detail::shaders.try_emplace(tag, vs_filename, fs_filename);
+}
+
+Shader get_shader(const std::string& tag) {
+    auto finder = texture_detail::shaders.find(tag);
+    if(finder == texture_detail::shaders.end()) {
+        throw std::runtime_error("Unable to find resource tag: " + tag);
+    }
+    return finder->second.shader;
+}
+
 
 }  // namespace radl
@@ -7,6 +7,12 @@
 namespace radl {
 
 void register_texture(const std::string& filename, const std::string& tag);
+// Uploads @p image, the image stays owned by the caller
+void register_texture(const Image& image, const std::string& tag);
 Texture2D get_texture(const std::string& tag);
 
+void register_shader(const std::string& vs_filename,
+                     const std::string& fs_filename, const std::string& tag);
+Shader get_shader(const std::string& tag);
+
 }  // namespace radl
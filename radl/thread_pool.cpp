@@ -0,0 +1,162 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace radl {
+
+namespace {
+
+constexpr uint64_t pack(const uint64_t begin, const uint64_t end) {
+    return end << 32 | begin;
+}
+
+constexpr size_t range_begin(const uint64_t bounds) {
+    return static_cast<size_t>(bounds & 0xffffffffu);
+}
+
+constexpr size_t range_end(const uint64_t bounds) {
+    return static_cast<size_t>(bounds >> 32);
+}
+
+}  // namespace
+
+thread_pool_t::thread_pool_t(size_t threads) {
+    if(threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers = threads;
+    m_ranges  = std::make_unique<range_t[]>(threads);
+    for(size_t worker = 1; worker < threads; ++worker) {
+        m_threads.emplace_back(&thread_pool_t::thread_main, this, worker);
+    }
+}
+
+thread_pool_t::~thread_pool_t() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void thread_pool_t::thread_main(const size_t worker) {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true) {
+        m_wake.wait(lock, [&] { return m_stop || m_job != seen; });
+        if(m_stop) {
+            return;
+        }
+        seen = m_job;
+        lock.unlock();
+        work(worker);
+        lock.lock();
+        if(--m_busy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+
+bool thread_pool_t::take(const size_t worker, size_t& index) {
+    auto& bounds     = m_ranges[worker].bounds;
+    uint64_t current = bounds.load(std::memory_order_acquire);
+    while(true) {
+        const size_t begin = range_begin(current);
+        const size_t end   = range_end(current);
+        if(begin >= end) {
+            return false;
+        }
+        if(bounds.compare_exchange_weak(current, pack(begin + 1, end),
+                                        std::memory_order_acq_rel)) {
+            index = begin;
+            return true;
+        }
+    }
+}
+
+bool thread_pool_t::steal(const size_t worker) {
+    while(true) {
+        // the victim with the most work left
+        size_t victim    = worker;
+        size_t most      = 0;
+        uint64_t current = 0;
+        for(size_t other = 0; other < m_workers; ++other) {
+            const uint64_t bounds
+                = m_ranges[other].bounds.load(std::memory_order_acquire);
+            const size_t left = range_end(bounds) > range_begin(bounds)
+                                    ? range_end(bounds) - range_begin(bounds)
+                                    : 0;
+            if(other != worker && left > most) {
+                victim  = other;
+                most    = left;
+                current = bounds;
+            }
+        }
+        if(most == 0) {
+            return false;
+        }
+        // take the back half, the owner keeps working on the front
+        const size_t begin = range_begin(current);
+        const size_t end   = range_end(current);
+        const size_t split = begin + (end - begin) / 2;
+        if(m_ranges[victim].bounds.compare_exchange_strong(
+               current, pack(begin, split), std::memory_order_acq_rel)) {
+            m_ranges[worker].bounds.store(pack(split, end),
+                                          std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void thread_pool_t::work(const size_t worker) {
+    size_t index = 0;
+    do {
+        while(take(worker, index)) {
+            m_task(m_context, index, worker);
+        }
+    } while(steal(worker));
+}
+
+void thread_pool_t::run(const size_t count, const task_t task,
+                        void* context) {
+    if(count == 0) {
+        return;
+    }
+    if(count > 0xffffffffu) {
+        throw std::runtime_error("parallel_for: too many items");
+    }
+    std::lock_guard<std::mutex> run_lock(m_run_mutex);
+    if(m_workers == 1 || count == 1) {
+        for(size_t index = 0; index < count; ++index) {
+            task(context, index, 0);
+        }
+        return;
+    }
+    for(size_t worker = 0; worker < m_workers; ++worker) {
+        m_ranges[worker].bounds.store(
+            pack(count * worker / m_workers, count * (worker + 1) / m_workers),
+            std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task    = task;
+        m_context = context;
+        m_busy    = m_workers - 1;
+        ++m_job;
+    }
+    m_wake.notify_all();
+    work(0);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [&] { return m_busy == 0; });
+}
+
+thread_pool_t& default_thread_pool() {
+    static thread_pool_t pool;
+    return pool;
+}
+
+}  // namespace radl
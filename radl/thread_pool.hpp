@@ -0,0 +1,99 @@
+/*
+ * A small work-stealing thread pool for data parallel loops.
+ *
+ * parallel_for splits [0, count) into one range per worker. Each worker takes
+ * indices from the front of its own range, and when it runs dry steals the
+ * back half of the largest range left, so uneven items (a long path next to
+ * short ones) still keep every core busy. The calling thread works too.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace radl {
+
+class thread_pool_t {
+private:
+    // [begin, end) packed in one word, so the owner and the thieves can both
+    // update it with a single compare and swap
+    struct alignas(64) range_t {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    using task_t = void (*)(void* context, size_t index, size_t worker);
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<range_t[]> m_ranges;
+    size_t m_workers = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    // bumped for every parallel_for, the threads wait for it to change
+    uint64_t m_job  = 0;
+    size_t m_busy   = 0;
+    bool m_stop     = false;
+    task_t m_task   = nullptr;
+    void* m_context = nullptr;
+    // serialises parallel_for calls from different threads
+    std::mutex m_run_mutex;
+
+    void thread_main(size_t worker);
+    void work(size_t worker);
+    bool take(size_t worker, size_t& index);
+    bool steal(size_t worker);
+    void run(size_t count, task_t task, void* context);
+
+    template <typename F>
+    static void invoke(void* context, const size_t index, const size_t worker) {
+        (*static_cast<F*>(context))(index, worker);
+    }
+
+public:
+    /**
+     * @param threads number of workers, the calling thread included; 0 uses
+     * one per hardware thread
+     */
+    explicit thread_pool_t(size_t threads = 0);
+    ~thread_pool_t();
+
+    thread_pool_t(const thread_pool_t&)            = delete;
+    thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+    /**
+     * @brief Number of workers, the calling thread included. Worker numbers
+     * passed to the tasks are below this.
+     */
+    inline size_t size() const noexcept {
+        return m_workers;
+    }
+
+    /**
+     * @brief Calls fn(index, worker) for every index in [0, count) and
+     * returns once all are done. fn runs concurrently on several threads and
+     * must not throw.
+     */
+    template <typename F>
+    void parallel_for(const size_t count, F&& fn) {
+        using fn_t = std::remove_reference_t<F>;
+        run(count, &invoke<fn_t>, const_cast<void*>(static_cast<const void*>(
+                                      std::addressof(fn))));
+    }
+};
+
+/**
+ * @brief A pool shared by the library, one worker per hardware thread.
+ * Created on first use.
+ */
+thread_pool_t& default_thread_pool();
+
+}  // namespace radl
@@ -0,0 +1,85 @@
+/*
+ * Lock free triple buffer: one writer thread fills the back slot and publishes
+ * it, one reader thread picks up the most recently published slot. Neither
+ * side ever waits for the other, and the reader never sees a half written
+ * slot.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace radl {
+
+template <typename T>
+class triple_buffer_t {
+private:
+    // set in m_ready while the reader hasn't taken the published slot
+    static constexpr uint8_t fresh_bit  = 4;
+    static constexpr uint8_t index_mask = 3;
+
+    std::array<T, 3> m_slots;
+    // slot last published (or given back by the reader)
+    std::atomic<uint8_t> m_ready{1};
+    // only touched by the writer
+    uint8_t m_back = 0;
+    // only touched by the reader
+    uint8_t m_front = 2;
+
+public:
+    /**
+     * @brief Sets every slot to @p value and forgets any published slot. Not
+     * thread safe, neither side may be running.
+     */
+    inline void reset(const T& value) {
+        for(auto& slot : m_slots) {
+            slot = value;
+        }
+        m_ready.store(1, std::memory_order_relaxed);
+        m_back  = 0;
+        m_front = 2;
+    }
+
+    /**
+     * @brief The slot the writer fills, writer thread only.
+     */
+    inline T& back() noexcept {
+        return m_slots[m_back];
+    }
+
+    /**
+     * @brief Publishes the back slot, writer thread only.
+     */
+    inline void publish() noexcept {
+        const uint8_t previous = m_ready.exchange(m_back | fresh_bit,
+                                                  std::memory_order_acq_rel);
+        m_back = previous & index_mask;
+    }
+
+    /**
+     * @brief Makes the most recently published slot the front one, reader
+     * thread only.
+     *
+     * @return false if nothing was published since the last acquire
+     */
+    inline bool acquire() noexcept {
+        if(!(m_ready.load(std::memory_order_acquire) & fresh_bit)) {
+            return false;
+        }
+        const uint8_t previous
+            = m_ready.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & index_mask;
+        return true;
+    }
+
+    /**
+     * @brief The slot the reader uses, reader thread only.
+     */
+    inline const T& front() const noexcept {
+        return m_slots[m_front];
+    }
+};
+
+}  // namespace radl
@@ -35,11 +35,11 @@ struct vchar_t {
         , background(color_t{br, bg, bb, ba}) {}
 
     bool operator==(const vchar_t& rhs) const {
-        return std::tuple{glyph, foreground, background}
-               == std::tuple{rhs.glyph, rhs.foreground, rhs.background};
+        return glyph == rhs.glyph && foreground == rhs.foreground
+               && background == rhs.background;
     }
 
-    bool operator!=(const vchar_t& rhs) {
+    bool operator!=(const vchar_t& rhs) const {
         return !operator==(rhs);
     }
 
@@ -1,35 +1,86 @@
 #include "virtual_terminal.hpp"
 #include <algorithm>
+#include <bit>
 #include <mutex>
-#include <ranges>
 
-#include "raymath.h"
-#include "rlgl.h"
-#include "texture_resources.hpp"
+#include "gpu_resident_renderer.hpp"
+#include "instanced_renderer.hpp"
+#include "raylib_backend.hpp"
 
 namespace radl {
 
 
 void virtual_terminal::set_char(const int index, const vchar_t& vch) {
-    auto lock       = std::lock_guard(m_mutex);
-    m_buffer[index] = vch;
+    const int y = index / term_width;
+    auto lock   = m_row_locks.lock_row(y);
+    write_cell(index % term_width, y, index, vch);
+}
+
+void virtual_terminal::set_char(const int x, const int y, const vchar_t& vch) {
+    auto lock = m_row_locks.lock_row(y);
+    write_cell(x, y, at(x, y), vch);
+}
+
+void virtual_terminal::set_char(const int x, const int y,
+                                const palette_cell_t& cell) {
+    auto lock = m_row_locks.lock_row(y);
+    write_cell(x, y, at(x, y), cell);
+}
+
+void virtual_terminal::write_row(const int x, const int y,
+                                 std::span<const vchar_t> cells) {
+    blit(x, y, static_cast<int>(cells.size()), 1, cells);
+}
+
+void virtual_terminal::blit(const int x, const int y, const int w, const int h,
+                            std::span<const vchar_t> cells) {
+    assert(cells.size() >= static_cast<size_t>(w) * h);
+    const int x0 = std::max(x, 0);
+    const int x1 = std::min(x + w, term_width);
+    const int y0 = std::max(y, 0);
+    const int y1 = std::min(y + h, term_height);
+    auto lock    = m_row_locks.lock(y0, y1);
+    for(int cy = y0; cy < y1; ++cy) {
+        const vchar_t* src = cells.data() + (cy - y) * w;
+        int index          = at(x0, cy);
+        for(int cx = x0; cx < x1; ++cx, ++index) {
+            write_cell(cx, cy, index, src[cx - x]);
+        }
+    }
+}
+
+void virtual_terminal::writer_t::print(const int x, const int y,
+                                       const std::string& str,
+                                       const color_t& fg, const color_t& bg) {
+    int idx = static_cast<int>(m_term->at(x, y));
+    for(const auto& ch : str) {
+        set_char(idx, vchar_t{ch, fg, bg});
+        ++idx;
+    }
 }
 
 void virtual_terminal::fill(const vchar_t& vch) {
-    auto lock = std::lock_guard(m_mutex);
-    std::fill(m_buffer.begin(), m_buffer.end(), vch);
+    constexpr int chunk = cell_buffer_t::chunk_size;
+    auto lock           = m_row_locks.lock_all();
+    for(int y = 0; y < term_height; ++y) {
+        for(int x = 0; x < term_width; x += chunk) {
+            const int count        = std::min(chunk, term_width - x);
+            const uint32_t changed = m_buffer.assign(at(x, y), count, vch);
+            m_dirty_cells.mark_bits(x, y, changed);
+        }
+    }
 }
 
 void virtual_terminal::resize_chars(const int width, const int height) {
-    this->term_width              = width;
-    this->term_height             = height;
-    const auto& [fwidth, fheight] = m_font->character_size;
-    // RAII automatically unloads the previous texture and loads a new one
-    this->m_backing
-        = std::make_unique<render_texture_t>(width * fwidth, height * fheight);
+    this->term_width  = width;
+    this->term_height = height;
+    // the backing texture and renderer follow at the next render, from the
+    // render thread
     m_buffer.resize(width * height);
+    m_dirty_cells.resize(width, height);
+    m_row_locks.resize(height);
     clear();
-    m_buffer_prev.resize(width * height);
+    invalidate();
 }
 
 void virtual_terminal::resize_pixels(const int width_px, const int height_px) {
@@ -40,11 +91,10 @@ void virtual_terminal::resize_pixels(const int width_px, const int height_px) {
 
 void virtual_terminal::print(const int x, const int y, const std::string& str,
                              const color_t& fg, const color_t& bg) {
-    int idx = at(x, y);
-    for(const auto& ch : str) {
-        set_char(idx, vchar_t{ch, fg, bg});
-        ++idx;
-    }
+    // the text may wrap to the following rows
+    const auto last_index = static_cast<int>(at(x, y) + str.size()) - 1;
+    writer(y, std::max(y, last_index / term_width) + 1)
+        .print(x, y, str, fg, bg);
 }
 
 void virtual_terminal::print_center(const int y, const std::string& str,
@@ -56,49 +106,193 @@ void virtual_terminal::print_center(const int y, const std::string& str,
 void virtual_terminal::box(const int x, const int y, const int w, const int h,
                            const color_t& fg, const color_t& bg,
                            bool double_lines) {
+    auto out = writer(y, y + h + 1);
     // horizontal
     for(int i = 1; i < w; ++i) {
         if(!double_lines) {
-            set_char(x + i, y, vchar_t{196, fg, bg});
-            set_char(x + i, y + h, vchar_t{196, fg, bg});
+            out.set_char(x + i, y, vchar_t{196, fg, bg});
+            out.set_char(x + i, y + h, vchar_t{196, fg, bg});
         } else {
-            set_char(x + i, y, vchar_t{205, fg, bg});
-            set_char(x + i, y + h, vchar_t{205, fg, bg});
+            out.set_char(x + i, y, vchar_t{205, fg, bg});
+            out.set_char(x + i, y + h, vchar_t{205, fg, bg});
         }
     }
     // vertical
     for(int i = 1; i < h; ++i) {
         if(!double_lines) {
-            set_char(x, y + i, vchar_t{179, fg, bg});
-            set_char(x + w, y + i, vchar_t{179, fg, bg});
+            out.set_char(x, y + i, vchar_t{179, fg, bg});
+            out.set_char(x + w, y + i, vchar_t{179, fg, bg});
         } else {
-            set_char(x, y + i, vchar_t{186, fg, bg});
-            set_char(x + w, y + i, vchar_t{186, fg, bg});
+            out.set_char(x, y + i, vchar_t{186, fg, bg});
+            out.set_char(x + w, y + i, vchar_t{186, fg, bg});
         }
     }
     // corners
     if(!double_lines) {
-        set_char(x, y, vchar_t{218, fg, bg});
-        set_char(x + w, y, vchar_t{191, fg, bg});
-        set_char(x, y + h, vchar_t{192, fg, bg});
-        set_char(x + w, y + h, vchar_t{217, fg, bg});
+        out.set_char(x, y, vchar_t{218, fg, bg});
+        out.set_char(x + w, y, vchar_t{191, fg, bg});
+        out.set_char(x, y + h, vchar_t{192, fg, bg});
+        out.set_char(x + w, y + h, vchar_t{217, fg, bg});
     } else {
-        set_char(x, y, vchar_t{201, fg, bg});
-        set_char(x + w, y, vchar_t{187, fg, bg});
-        set_char(x, y + h, vchar_t{200, fg, bg});
-        set_char(x + w, y + h, vchar_t{188, fg, bg});
+        out.set_char(x, y, vchar_t{201, fg, bg});
+        out.set_char(x + w, y, vchar_t{187, fg, bg});
+        out.set_char(x, y + h, vchar_t{200, fg, bg});
+        out.set_char(x + w, y + h, vchar_t{188, fg, bg});
     }
 }
 
-static void set_rectangle_position_from_vchar(Rectangle& rect,
-                                              const radl::vchar_t& vchar,
-                                              const radl::bitmap_font& font) {
-    const auto& [font_width, font_height] = font.character_size;
-    // 16x16 because the CP437 grid is in this format
-    rect.x = vchar.glyph % 16 * font_width;
-    rect.y = vchar.glyph / 16 * font_height;
+
+void virtual_terminal::set_render_mode(const render_mode_t mode) {
+    if(mode == m_render_mode) {
+        return;
+    }
+    if(mode != render_mode_t::diff) {
+        // the whole terminal renderers talk to rlgl directly, throws otherwise
+        get_raylib_backend();
+    }
+    m_render_mode = mode;
+    switch(mode) {
+    case render_mode_t::diff:
+        m_renderer.reset();
+        break;
+    case render_mode_t::instanced:
+        m_renderer = std::make_unique<instanced_renderer>();
+        break;
+    case render_mode_t::gpu_resident:
+        m_renderer = std::make_unique<gpu_resident_renderer>();
+        break;
+    }
+    // the next render sizes the new renderer
+    m_render_width  = -1;
+    m_render_height = -1;
+    invalidate();
+}
+
+void virtual_terminal::set_palette(const palette_t& palette) {
+    auto lock = m_row_locks.lock_all();
+    if(m_palette) {
+        // Same cells and encoding, new colors
+        m_palette->recolor(palette);
+    } else {
+        m_palette = std::make_unique<palette_t>(palette);
+        m_buffer.set_palette(m_palette.get());
+    }
+    ++m_palette_version;
+    // render() repaints everything once it draws cells of the new version
+    dirty = true;
+}
+
+void virtual_terminal::clear_palette() {
+    if(!m_palette) {
+        return;
+    }
+    auto lock = m_row_locks.lock_all();
+    m_buffer.set_palette(nullptr);
+    m_palette.reset();
+    ++m_palette_version;
+    // render() repaints everything once it draws cells of the new version
+    dirty = true;
+}
+
+void virtual_terminal::set_snapshot_mode(const bool enabled) {
+    if(enabled == get_snapshot_mode()) {
+        return;
+    }
+    if(enabled) {
+        m_snapshots = std::make_unique<triple_buffer_t<snapshot_t>>();
+        reset_snapshots();
+    } else {
+        m_snapshots.reset();
+    }
+    invalidate();
+}
+
+void virtual_terminal::store_snapshot(snapshot_t& snapshot) const {
+    if(snapshot.palette_version != m_palette_version) {
+        if(m_palette) {
+            snapshot.palette = *m_palette;
+        }
+        snapshot.palette_version = m_palette_version;
+    }
+    snapshot.cells = m_buffer;
+    if(m_palette) {
+        // m_palette changes under the render thread, the copy doesn't
+        snapshot.cells.bind_palette(&snapshot.palette);
+    }
+    snapshot.width  = term_width;
+    snapshot.height = term_height;
 }
 
+void virtual_terminal::reset_snapshots() {
+    if(m_snapshots) {
+        auto lock = m_row_locks.lock_all();
+        snapshot_t snapshot;
+        store_snapshot(snapshot);
+        m_snapshots->reset(snapshot);
+    }
+}
+
+void virtual_terminal::publish() {
+    if(!m_snapshots) {
+        return;
+    }
+    auto lock = m_row_locks.lock_all();
+    store_snapshot(m_snapshots->back());
+    // the render side diffs whole snapshots, the marks are not needed
+    m_dirty_cells.clear();
+    m_snapshots->publish();
+}
+
+void virtual_terminal::invalidate() {
+    m_invalid = true;
+    dirty     = true;
+}
+
+void virtual_terminal::make_backing() {
+    if(m_backing) {
+        return;
+    }
+    const auto& [fwidth, fheight] = m_font->character_size;
+
+    m_backing = std::make_unique<render_target_t>(m_render_width * fwidth,
+                                                  m_render_height * fheight);
+    m_backing->clear();
+}
+
+void virtual_terminal::prepare_render(const cell_buffer_t& cells,
+                                      const int width, const int height,
+                                      const uint64_t palette_version) {
+    const bool resized = width != m_render_width || height != m_render_height;
+    if(resized) {
+        m_render_width  = width;
+        m_render_height = height;
+        // RAII unloads the previous texture, make_backing creates the new one
+        m_backing.reset();
+        if(m_renderer) {
+            m_renderer->resize(width, height);
+        }
+    }
+    if(resized || (cells.palette() == nullptr)
+                      != (m_buffer_prev.palette() == nullptr)) {
+        m_buffer_prev.set_palette(cells.palette());
+        m_buffer_prev.resize(cells.size());
+        m_invalid = true;
+    }
+    // palette cells keep their indices across a recolor, the diff would see
+    // no change
+    if(palette_version != m_render_palette_version) {
+        m_render_palette_version = palette_version;
+        m_invalid                = true;
+    }
+    make_backing();
+    if(m_invalid.exchange(false)) {
+        m_buffer_prev.mismatch(cells);
+        if(&cells == &m_buffer) {
+            m_dirty_cells.mark_all();
+        }
+        m_backing->clear();
+    }
+}
 
 void virtual_terminal::render() {
     if(!visible) {
@@ -109,69 +303,131 @@ void virtual_terminal::render() {
         throw std::runtime_error("Font not loaded: " + m_font_tag);
     }
 
+    if(m_snapshots && m_snapshots->acquire()) {
+        dirty = true;
+    }
+
     if(dirty) {
         dirty = false;
-
-        Vector2 font_size = {
-            static_cast<float>(m_font->character_size.first),
-            static_cast<float>(m_font->character_size.second),
-        };
-        Rectangle tex_src_rect{
-            0,
-            0,
-            font_size.x,
-            font_size.y,
-        };
-
-        BeginTextureMode(m_backing->render_texture);
-        // clear everything that has changed
-        BeginBlendMode(BLEND_SUBTRACT_COLORS);
-        Vector2 pos{0.f, static_cast<float>(term_height - 1)};
-        // assert(m_buffer_prev.size() == m_buffer.size());
-        for(auto&& [prev_vch, vch] : std::views::zip(m_buffer_prev, m_buffer)) {
-            const Vector2 pos_bg = Vector2Multiply(pos, font_size);
-            if(vch != prev_vch) {  // vch changed
-                if(m_has_background
-                   && vch.background.a != 0) {  // has bg and alpha channel
-                    rlSetBlendMode(BLEND_ALPHA);
-                    DrawRectangleRec(
-                        Rectangle{pos_bg.x, pos_bg.y, font_size.x, font_size.y},
-                        vch.background);
-                } else {
-                    rlSetBlendMode(BLEND_SUBTRACT_COLORS);
-                    DrawRectangleRec(
-                        Rectangle{pos_bg.x, pos_bg.y, font_size.x, font_size.y},
-                        BLANK);
-                }
+        if(m_snapshots) {
+            // the front snapshot is only touched by this thread, no locking
+            const auto& frame = m_snapshots->front();
+            prepare_render(frame.cells, frame.width, frame.height,
+                           frame.palette_version);
+            if(m_renderer) {
+                auto& target
+                    = get_raylib_backend().render_texture(m_backing->id());
+                m_renderer->render(target, *m_font, frame.cells,
+                                   m_has_background);
+            } else {
+                render_diff(frame.cells);
+            }
+        } else {
+            // writers mark cells while they hold their rows: gathering and
+            // clearing the marks must not race them
+            auto lock = m_row_locks.lock_all();
+            prepare_render(m_buffer, term_width, term_height,
+                           m_palette_version);
+            if(m_renderer) {
+                auto& target
+                    = get_raylib_backend().render_texture(m_backing->id());
+                m_renderer->render(target, *m_font, m_buffer,
+                                   m_has_background);
+                m_dirty_cells.clear();
+            } else {
+                render_diff(m_buffer);
             }
-            // increment vchar position
-            pos.x += 1.f;
-            if(pos.x >= term_width) {
-                pos.x = 0.f;
-                pos.y -= 1.f;
+        }
+    }
+}
+
+void virtual_terminal::render_diff(const cell_buffer_t& cells) {
+    // Gather the cells that differ from what was last rendered, 32 cells at a
+    // time. Snapshots have no dirty marks, all their cells are compared.
+    constexpr int chunk    = cell_buffer_t::chunk_size;
+    const bool whole_frame = &cells != &m_buffer;
+    // a snapshot may not have the current terminal size
+    const int width  = m_render_width;
+    const int height = m_render_height;
+    m_changed.clear();
+    for(int y = 0; y < height; ++y) {
+        dirty_mask_t::span_t span{0, width - 1};
+        if(!whole_frame) {
+            span = m_dirty_cells.row_span(y);
+            if(span.empty()) {
+                continue;
             }
         }
-        EndBlendMode();
-
-        m_tex = radl::get_texture(this->m_font->texture_tag);
-        pos   = Vector2{0.f, static_cast<float>(term_height - 1)};
-        for(auto&& [prev_vch, vch] : std::views::zip(m_buffer_prev, m_buffer)) {
-            // if vch has changed
-            if(vch != prev_vch) {
-                prev_vch             = vch;
-                const Vector2 pos_bg = Vector2Multiply(pos, font_size);
-                set_rectangle_position_from_vchar(tex_src_rect, vch, *m_font);
-                DrawTextureRec(m_tex, tex_src_rect, pos_bg, vch.foreground);
+        for(int x = span.min & ~(chunk - 1); x <= span.max; x += chunk) {
+            const uint32_t touched
+                = whole_frame ? ~uint32_t{0} : m_dirty_cells.bits32(x, y);
+            if(touched == 0) {
+                continue;
             }
-            // increment vchar position
-            pos.x += 1.f;
-            if(pos.x >= term_width) {
-                pos.x = 0.f;
-                pos.y -= 1.f;
+            const int first = y * width + x;
+            uint32_t changed
+                = touched
+                  & cells.diff(m_buffer_prev, first,
+                               std::min(chunk, width - x));
+            while(changed) {
+                m_changed.push_back(first + std::countr_zero(changed));
+                changed &= changed - 1;
             }
         }
-        EndTextureMode();
     }
+    if(!whole_frame) {
+        m_dirty_cells.clear();
+    }
+    if(m_changed.empty()) {
+        return;
+    }
+
+    Vector2 font_size = {
+        static_cast<float>(m_font->character_size.first),
+        static_cast<float>(m_font->character_size.second),
+    };
+    // Position of a cell in the backing texture, the first row is at the
+    // bottom (the texture gets y-flipped when drawn)
+    const auto cell_rect = [width, height, &font_size](const int index) {
+        return Rectangle{
+            static_cast<float>(index % width) * font_size.x,
+            static_cast<float>(height - 1 - index / width) * font_size.y,
+            font_size.x,
+            font_size.y,
+        };
+    };
+
+    // clear everything that has changed, cells with a background are drawn
+    // over instead
+    m_quads.clear();
+    m_clear_quads.clear();
+    for(const int index : m_changed) {
+        const auto vch = cells.get(index);
+        if(m_has_background
+           && vch.background.a != 0) {  // has bg and alpha channel
+            m_quads.push_back(quad_t{{}, cell_rect(index), vch.background});
+        } else {
+            m_clear_quads.push_back(quad_t{{}, cell_rect(index), BLANK});
+        }
+    }
+
+    auto& backend = get_render_backend();
+    backend.begin_target(m_backing->id());
+    backend.draw_quads(texture_ref_t{}, m_clear_quads,
+                       blend_t::subtract_colors);
+    backend.draw_quads(texture_ref_t{}, m_quads, blend_t::alpha);
+
+    m_quads.clear();
+    Rectangle tex_src_rect{0, 0, font_size.x, font_size.y};
+    for(const int index : m_changed) {
+        const auto vch = cells.get(index);
+        m_buffer_prev.copy(index, cells);
+        set_rectangle_position_from_vchar(tex_src_rect, vch, *m_font);
+        m_quads.push_back(
+            quad_t{tex_src_rect, cell_rect(index), vch.foreground});
+    }
+    backend.draw_quads(backend.font_texture(*m_font), m_quads, blend_t::alpha);
+    backend.end_target();
 }
 
 }  // namespace radl
@@ -1,22 +1,45 @@
 #pragma once
 
+#include <atomic>
+#include <cassert>
+#include <cstdint>
 #include <memory>
-#include <mutex>
+#include <span>
 #include <vector>
 
 #include <raylib.h>
 
+#include "cell_buffer.hpp"
+#include "cell_renderer.hpp"
 #include "color_t.hpp"
 #include "colors.hpp"
+#include "dirty_mask.hpp"
 #include "font_manager.hpp"
-#include "texture.hpp"
+#include "palette.hpp"
+#include "render_backend.hpp"
+#include "row_locks.hpp"
+#include "triple_buffer.hpp"
 #include "vchar.hpp"
 
 namespace radl {
 
+/*
+ * How a virtual_terminal draws its cells into the backing texture.
+ */
+enum class render_mode_t {
+  // Redraw only the cells that changed since the last render, one draw call
+  // per cell
+  diff,
+  // Redraw the whole terminal with one instanced draw call per layer
+  // (background, glyphs)
+  instanced,
+  // Keep the cells in data textures and resolve them in a fragment shader,
+  // the whole terminal is a single quad
+  gpu_resident,
+};
+
 class virtual_terminal {
 private:
-  Texture2D m_tex;
   std::string m_font_tag;
   int m_offset_x;
   int m_offset_y;
@@ -24,23 +47,169 @@ private:
   bool m_has_background;
   bitmap_font *m_font = nullptr;
   // we can have a list of position? that's what the buffer is for
-  std::vector<vchar_t> m_buffer;
-  std::vector<vchar_t> m_buffer_prev;
-  std::unique_ptr<render_texture_t> m_backing;
+  cell_buffer_t m_buffer;
+  cell_buffer_t m_buffer_prev;
+  // cells written since the last render, only those are diffed and redrawn
+  dirty_mask_t m_dirty_cells;
+  // scratch list of the cells redrawn by render_diff
+  std::vector<int> m_changed;
+  // scratch quads of render_diff
+  std::vector<quad_t> m_quads;
+  std::vector<quad_t> m_clear_quads;
+  std::unique_ptr<render_target_t> m_backing;
+  render_mode_t m_render_mode = render_mode_t::diff;
+  // Only used by the whole terminal render modes
+  std::unique_ptr<cell_renderer> m_renderer;
+  // Set in palette mode, the cells hold palette indices into it
+  std::unique_ptr<palette_t> m_palette;
+  // bumped at every palette change, snapshots copy the palette when it moved
+  uint64_t m_palette_version = 0;
+
+  // Size m_buffer_prev, m_backing and m_renderer are set up for, render side
+  // only: the writer may resize the terminal meanwhile in snapshot mode
+  int m_render_width = -1;
+  int m_render_height = -1;
+  // palette_version of the cells drawn last
+  uint64_t m_render_palette_version = ~uint64_t{0};
+  // Set by invalidate(), render() then forgets what it drew
+  std::atomic<bool> m_invalid = true;
+
+  // one lock per row, see set_thread_safe
+  row_locks_t m_row_locks;
+
+  /*
+   * A published frame. It carries its own size and palette, so the writer can
+   * resize or recolor the terminal while it is drawn.
+   */
+  struct snapshot_t {
+    cell_buffer_t cells;
+    palette_t palette;
+    uint64_t palette_version = ~uint64_t{0};
+    int width = 0;
+    int height = 0;
+
+    snapshot_t() = default;
+    snapshot_t(const snapshot_t &rhs) { *this = rhs; }
+
+    snapshot_t &operator=(const snapshot_t &rhs) {
+      cells = rhs.cells;
+      if (palette_version != rhs.palette_version) {
+        palette = rhs.palette;
+        palette_version = rhs.palette_version;
+      }
+      if (cells.palette()) {
+        cells.bind_palette(&palette);
+      }
+      width = rhs.width;
+      height = rhs.height;
+      return *this;
+    }
+  };
+
+  // Set in snapshot mode: the writer publishes copies of m_buffer, render
+  // draws the latest one
+  std::unique_ptr<triple_buffer_t<snapshot_t>> m_snapshots;
+
+  /**
+   * @brief Redraws the cells of @p cells that changed since the last render.
+   * Only the dirty cells are compared when @p cells is m_buffer, every cell
+   * otherwise. The caller must hold every row lock when it is m_buffer.
+   */
+  void render_diff(const cell_buffer_t &cells);
+
+  /**
+   * @brief Sets the render side up for the @p width x @p height @p cells
+   * about to be drawn: resizes it when they changed size or palette mode,
+   * repaints everything when their @p palette_version is not the one drawn
+   * last, and carries out a pending invalidate(). Render thread only.
+   */
+  void prepare_render(const cell_buffer_t &cells, int width, int height,
+                      uint64_t palette_version);
+
+  /**
+   * @brief Copies the cells, palette and size into @p snapshot. The caller
+   * must hold every row lock.
+   */
+  void store_snapshot(snapshot_t &snapshot) const;
+
+  /**
+   * @brief Starts the snapshots over from the current cells.
+   */
+  void reset_snapshots();
+
+  /**
+   * @brief Stores @p vch at x/y (buffer @p index) and marks the cell dirty if
+   * it changed. The caller must hold the row lock.
+   */
+  inline void write_cell(int x, int y, int index, const vchar_t &vch) {
+    if (m_buffer.assign(index, vch)) {
+      m_dirty_cells.mark(x, y);
+    }
+  }
+
+  inline void write_cell(int x, int y, int index, const palette_cell_t &cell) {
+    if (m_buffer.assign(index, cell)) {
+      m_dirty_cells.mark(x, y);
+    }
+  }
+
+  /**
+   * @brief Makes the next render forget what was rendered and redraw every
+   * cell. Safe from the writer thread, the render thread does the work.
+   */
+  void invalidate();
 
-  std::mutex m_mutex;
+  /**
+   * @brief Creates the backing texture on first use, so terminals that are
+   * never rendered (e.g. drawn by the software_rasterizer) need no GL context.
+   */
+  void make_backing();
 
 public:
   int term_width;
   int term_height;
   bool visible = true;
-  bool dirty = true; // Flag for requiring a re-draw
+  std::atomic<bool> dirty = true; // Flag for requiring a re-draw
+
+  /**
+   * @brief Scoped batch writer: locks a band of rows once and writes any number
+   * of cells in it without further locking. Writers of disjoint bands can be
+   * used from different threads at the same time.
+   */
+  class writer_t {
+  private:
+    virtual_terminal *m_term;
+    int m_y0;
+    int m_y1;
+    row_locks_t::guard_t m_guard;
+
+  public:
+    writer_t(virtual_terminal &term, int y0, int y1)
+        : m_term(&term), m_y0(y0), m_y1(y1),
+          m_guard(term.m_row_locks.lock(y0, y1)) {}
+
+    /**
+     * @brief Set the char at x/y, y must be inside the writer band.
+     */
+    inline void set_char(int x, int y, const vchar_t &vch) {
+      assert(y >= m_y0 && y < m_y1);
+      m_term->write_cell(x, y, static_cast<int>(m_term->at(x, y)), vch);
+    }
+
+    inline void set_char(int index, const vchar_t &vch) {
+      set_char(index % m_term->term_width, index / m_term->term_width, vch);
+    }
+
+    void print(int x, int y, const std::string &str,
+               const color_t &fg = colors::White,
+               const color_t &bg = colors::NONE);
+  };
 
   virtual_terminal(const std::string &fontt, const int x = 0, const int y = 0,
                    const bool background = false)
       : m_font_tag(fontt), m_offset_x(x), m_offset_y(y),
         m_has_background(background) {
-    m_font = get_font(fontt);
+    m_font = radl::get_font(fontt);
   }
 
   ~virtual_terminal() = default;
@@ -53,7 +222,27 @@ public:
    * @param y
    * @return size_t
    */
-  inline size_t at(int x, int y) noexcept { return x + y * term_width; }
+  inline size_t at(int x, int y) const noexcept { return x + y * term_width; }
+
+  /**
+   * @brief Returns the char at buffer @p index, as written: in palette mode a
+   * recolor doesn't change its colors, so it can be written back.
+   */
+  inline vchar_t get_char(int index) const {
+    return m_buffer.get_written(index);
+  }
+
+  inline vchar_t get_char(int x, int y) const {
+    return m_buffer.get_written(at(x, y));
+  }
+
+  /**
+   * @brief Returns the char at x/y as it is drawn, with the colors the
+   * palette entries resolve to in palette mode.
+   */
+  inline vchar_t get_drawn_char(int x, int y) const {
+    return m_buffer.get(at(x, y));
+  }
 
   /**
    * @brief Fills the terminal with @p vch
@@ -80,10 +269,95 @@ public:
    */
   void set_char(int index, const vchar_t &vch);
 
-  inline void set_char(int x, int y, const vchar_t &vch) {
-    set_char(at(x, y), vch);
+  void set_char(int x, int y, const vchar_t &vch);
+
+  /**
+   * @brief Set the char at x/y from palette indices, only valid in palette
+   * mode (see set_palette).
+   */
+  void set_char(int x, int y, const palette_cell_t &cell);
+
+  /**
+   * @brief Returns a batch writer for the rows [y0, y1).
+   */
+  [[nodiscard]] inline writer_t writer(int y0, int y1) {
+    return writer_t{*this, y0, y1};
+  }
+
+  /**
+   * @brief Returns a batch writer for the whole terminal.
+   */
+  [[nodiscard]] inline writer_t writer() {
+    return writer_t{*this, 0, term_height};
   }
 
+  /**
+   * @brief Writes @p cells starting at x/y, locking the row once. Cells past
+   * the end of the row are dropped.
+   */
+  void write_row(int x, int y, std::span<const vchar_t> cells);
+
+  inline void write_row(int y, std::span<const vchar_t> cells) {
+    write_row(0, y, cells);
+  }
+
+  /**
+   * @brief Copies the @p w x @p h row-major @p cells to the rectangle at x/y,
+   * locking the rows it covers once. The rectangle is clipped to the terminal.
+   */
+  void blit(int x, int y, int w, int h, std::span<const vchar_t> cells);
+
+  /**
+   * @brief Enables/disables the per-row locking. Terminals written by a single
+   * thread (the default in most games) can skip locking altogether.
+   */
+  inline void set_thread_safe(bool thread_safe) noexcept {
+    m_row_locks.set_thread_safe(thread_safe);
+  }
+
+  /**
+   * @brief Switches the terminal to palette mode, 4 bytes per cell: a 16-bit
+   * glyph plus foreground/background indices into @p palette. Every color
+   * written afterwards must be in the palette. Entering palette mode clears
+   * the terminal; when already in it, only the colors the indices resolve to
+   * are swapped (e.g. to fade or recolor the whole terminal, see
+   * palette_t::lerp) and the cells are kept. The colors written keep encoding
+   * through the first palette, @p palette must have its size or this throws.
+   */
+  void set_palette(const palette_t &palette);
+
+  /**
+   * @brief Leaves palette mode, back to full color cells. Clears the terminal.
+   */
+  void clear_palette();
+
+  /**
+   * @brief The palette in use, nullptr when not in palette mode.
+   */
+  inline const palette_t *get_palette() const noexcept {
+    return m_palette.get();
+  }
+
+  /**
+   * @brief Enables/disables the snapshot mode, for a simulation thread writing
+   * the cells while the main thread renders: the writer calls publish() once a
+   * frame is complete, and render() draws the most recently published frame.
+   * Neither side blocks the other and frames never tear. Palette changes and
+   * resizes by the writer show with the next published frame. Switch it
+   * while no other thread uses the terminal.
+   */
+  void set_snapshot_mode(bool enabled);
+
+  inline bool get_snapshot_mode() const noexcept {
+    return m_snapshots != nullptr;
+  }
+
+  /**
+   * @brief Snapshot mode: publishes the cells written so far as a complete
+   * frame. Writer side, does nothing when not in snapshot mode.
+   */
+  void publish();
+
   /**
    * @brief Resize the terminal to match width x height pixels.
    */
@@ -118,6 +392,16 @@ public:
    */
   inline std::string get_font_tag() noexcept { return m_font->texture_tag; }
 
+  inline const bitmap_font &get_font() const noexcept { return *m_font; }
+
+  inline std::pair<int, int> get_offset() const noexcept {
+    return {m_offset_x, m_offset_y};
+  }
+
+  inline const color_t &get_tint() const noexcept { return m_tint; }
+
+  inline bool has_background() const noexcept { return m_has_background; }
+
   void print(int x, int y, const std::string &str,
              const color_t &fg = colors::White,
              const color_t &bg = colors::NONE);
@@ -150,6 +434,17 @@ public:
    */
   void render();
 
+  /**
+   * @brief Selects how the terminal is rendered, see render_mode_t.
+   *
+   * @param mode
+   */
+  void set_render_mode(render_mode_t mode);
+
+  inline render_mode_t get_render_mode() const noexcept {
+    return m_render_mode;
+  }
+
   /**
    * @brief Set the tint for the entire terminal
    *
@@ -170,26 +465,15 @@ public:
    * @param render_texture
    */
   inline void draw(bool yflipped = false) {
-    auto src_rect = Rectangle{
-        0.f,
-        0.f,
-        static_cast<float>(m_backing->render_texture.texture.width),
-        static_cast<float>(-m_backing->render_texture.texture.height),
-    };
-    if (yflipped) {
-      src_rect.height *= -1;
+    if (!m_backing) {
+      return;
     }
-    // NOTE: Render texture must be y-flipped due to default OpenGL
-    // coordinates (left-bottom)
-    DrawTextureRec(m_backing->render_texture.texture,
-                   // src rect
-                   src_rect,
-                   // position
-                   Vector2{
-                       static_cast<float>(m_offset_x),
-                       static_cast<float>(m_offset_y),
-                   },
-                   m_tint);
+    get_render_backend().present(m_backing->id(),
+                                 Vector2{
+                                     static_cast<float>(m_offset_x),
+                                     static_cast<float>(m_offset_y),
+                                 },
+                                 yflipped, m_tint);
   }
 };
 
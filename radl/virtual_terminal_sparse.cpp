@@ -1,7 +1,6 @@
 #include "virtual_terminal_sparse.hpp"
 
 #include "raymath.h"
-#include "texture_resources.hpp"
 
 namespace radl {
 
@@ -15,35 +14,50 @@ void virtual_terminal_sparse::resize_chars(const int width, const int height) {
     dirty                         = true;
     term_width                    = width;
     term_height                   = height;
-    const auto& [fwidth, fheight] = font->character_size;
-    backing
-        = std::make_unique<render_texture_t>(width * fwidth, height * fheight);
+    // created by the next render, so no GL context is needed until then
+    backing.reset();
 }
 
 void virtual_terminal_sparse::render() {
     if(!visible)
         return;
     if(dirty) {
-        dirty = false;
-        static const Vector2 font_size{
-            static_cast<float>(font->character_size.first),
-            static_cast<float>(font->character_size.second),
+        dirty                         = false;
+        const auto& [fwidth, fheight] = font->character_size;
+        if(!backing) {
+            backing = std::make_unique<render_target_t>(term_width * fwidth,
+                                                        term_height * fheight);
+        }
+        const Vector2 font_size{
+            static_cast<float>(fwidth),
+            static_cast<float>(fheight),
         };
-        static const auto tex = radl::get_texture(font->texture_tag);
-        BeginTextureMode(backing->render_texture);
-        ClearBackground(BLANK);
+        auto& backend = get_render_backend();
+        backend.begin_target(backing->id());
+        backend.clear(BLANK);
+
+        // consecutive glyphs are drawn as one batch, a background has to be
+        // drawn over the glyphs before it
+        const auto font_texture = backend.font_texture(*font);
         Rectangle tex_rect_src{0, 0, font_size.x, font_size.y};
-        for(auto& svch : buffer) {
-            tex_rect_src.x = (svch.glyph % 16) * font_size.x;
-            tex_rect_src.y = (svch.glyph / 16) * font_size.y;
-            Vector2 pos{svch.x, term_height - svch.y - 1};
-            Vector2 render_pos = Vector2Multiply(pos, font_size);
+        quads.clear();
+        for(const auto& svch : buffer) {
+            const Vector2 pos = Vector2Multiply(
+                Vector2{svch.x, term_height - svch.y - 1}, font_size);
+            const Rectangle dest{pos.x, pos.y, font_size.x, font_size.y};
             if(svch.has_background) {
-                DrawRectangleV(render_pos, font_size, svch.background);
+                backend.draw_quads(font_texture, quads, blend_t::alpha);
+                quads.clear();
+                const quad_t background{{}, dest, svch.background};
+                backend.draw_quads(texture_ref_t{}, {&background, 1},
+                                   blend_t::alpha);
             }
-            DrawTextureRec(tex, tex_rect_src, render_pos, svch.foreground);
+            const vchar_t vch{svch.glyph, svch.foreground, svch.background};
+            set_rectangle_position_from_vchar(tex_rect_src, vch, *font);
+            quads.push_back(quad_t{tex_rect_src, dest, svch.foreground});
         }
-        EndTextureMode();
+        backend.draw_quads(font_texture, quads, blend_t::alpha);
+        backend.end_target();
     }
 }
 
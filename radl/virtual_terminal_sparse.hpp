@@ -15,7 +15,7 @@
 #include "colors.hpp"
 #include "font_manager.hpp"
 #include "raylib.h"
-#include "texture.hpp"
+#include "render_backend.hpp"
 #include "vchar.hpp"
 
 namespace radl {
@@ -23,7 +23,6 @@ namespace radl {
 
 class virtual_terminal_sparse {
 private:
-    Texture2D tex = {0};
     std::string font_tag;
     int offset_x;
     int offset_y;
@@ -32,7 +31,9 @@ private:
     color_t tint{255, 255, 255, 255};
     bitmap_font* font = nullptr;
     std::vector<svchar_t> buffer;
-    std::unique_ptr<render_texture_t> backing;
+    // scratch quads of render
+    std::vector<quad_t> quads;
+    std::unique_ptr<render_target_t> backing;
 
 public:
     int term_width;
@@ -44,7 +45,7 @@ public:
         : font_tag(fontt)
         , offset_x(x)
         , offset_y(y) {
-        font = get_font(fontt);
+        font = radl::get_font(fontt);
     }
 
     void resize_pixels(const int width, const int height);
@@ -72,34 +73,37 @@ public:
 
     void render();
 
+    inline const std::vector<svchar_t>& get_chars() const noexcept {
+        return buffer;
+    }
+
+    inline const bitmap_font& get_font() const noexcept {
+        return *font;
+    }
+
+    inline std::pair<int, int> get_offset() const noexcept {
+        return {offset_x, offset_y};
+    }
+
+    inline const color_t& get_tint() const noexcept {
+        return tint;
+    }
+
     /**
      *  @brief Draw the entire backing texture to the screen
      *
      *  @param yflipped flip the y axis drawn
      */
     inline void draw(bool yflipped = false) {
-        // NOTE: Render texture must be y-flipped due to default OpenGL
-        // coordinates (left-bottom)
-        auto rect_height
-            = static_cast<float>(-backing->render_texture.texture.height);
-        if(yflipped) {
-            rect_height *= -1;
+        if(!backing) {
+            return;
         }
-        DrawTextureRec(
-            backing->render_texture.texture,
-            // src rect
-            Rectangle{
-                0.f,
-                0.f,
-                static_cast<float>(backing->render_texture.texture.width),
-                rect_height,
-            },
-            // position
-            Vector2{
-                static_cast<float>(offset_x),
-                static_cast<float>(offset_y),
-            },
-            tint);
+        get_render_backend().present(backing->id(),
+                                     Vector2{
+                                         static_cast<float>(offset_x),
+                                         static_cast<float>(offset_y),
+                                     },
+                                     yflipped, tint);
     }
 };
 
@@ -0,0 +1,68 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Glyph index per cell, little endian in the rgb channels. For palette cells
+// the glyph is in rg and the foreground/background palette indices in b/a.
+uniform sampler2D texture0;
+// Foreground and background color per cell
+uniform sampler2D foregrounds;
+uniform sampler2D backgrounds;
+// 256 x 1 colors, used when paletted != 0
+uniform sampler2D palette;
+// Font texture, a grid of atlasColumns glyphs per row (pages stacked)
+uniform sampler2D atlas;
+uniform int atlasColumns;
+uniform int atlasGlyphs;
+
+uniform ivec2 terminalSize;  // in cells
+uniform ivec2 cellSize;      // in pixels
+uniform int hasBackground;
+uniform int paletted;
+
+out vec4 finalColor;
+
+void main()
+{
+    // The first terminal row is at the bottom of the render texture, it gets
+    // y-flipped when drawn to the screen
+    vec2 position = fragTexCoord * vec2(terminalSize);
+    ivec2 cell = clamp(ivec2(floor(position)), ivec2(0), terminalSize - 1);
+    cell.y = terminalSize.y - 1 - cell.y;
+    ivec2 inCell = ivec2(fract(position) * vec2(cellSize));
+
+    ivec4 cellBytes = ivec4(texelFetch(texture0, cell, 0) * 255.0 + 0.5);
+    int glyph = cellBytes.r + cellBytes.g * 256;
+    vec4 foregroundColor;
+    vec4 backgroundColor;
+    if(paletted != 0)
+    {
+        foregroundColor = texelFetch(palette, ivec2(cellBytes.b, 0), 0);
+        backgroundColor = texelFetch(palette, ivec2(cellBytes.a, 0), 0);
+    }
+    else
+    {
+        glyph += cellBytes.b * 65536;
+        foregroundColor = texelFetch(foregrounds, cell, 0);
+        backgroundColor = texelFetch(backgrounds, cell, 0);
+    }
+    // Glyphs past the end of the atlas show glyph 0, as on the CPU renderers
+    if(glyph >= atlasGlyphs)
+        glyph = 0;
+    ivec2 glyphOrigin = ivec2(glyph % atlasColumns, glyph / atlasColumns)
+                      * cellSize;
+
+    vec4 foreground = texelFetch(atlas, glyphOrigin + inCell, 0)
+                    * foregroundColor;
+    vec4 background = vec4(0.0);
+    if(hasBackground != 0)
+        background = backgroundColor;
+
+    // Glyph over background
+    float alpha = foreground.a + background.a * (1.0 - foreground.a);
+    vec3 color = foreground.rgb * foreground.a
+               + background.rgb * background.a * (1.0 - foreground.a);
+    finalColor = vec4(color / max(alpha, 0.0001), alpha);
+}
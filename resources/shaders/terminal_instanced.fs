@@ -0,0 +1,18 @@
+#version 330
+
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+uniform sampler2D texture0;
+// 0: background pass, 1: glyph pass
+uniform int pass;
+
+out vec4 finalColor;
+
+void main()
+{
+    if(pass == 0)
+        finalColor = fragColor;
+    else
+        finalColor = texture(texture0, fragTexCoord) * fragColor;
+}
@@ -0,0 +1,33 @@
+#version 330
+
+// Per-vertex corner of the unit cell quad
+layout(location = 0) in vec2 vertexCorner;
+
+// Per-instance (per-cell) attributes
+layout(location = 1) in vec2 instanceGlyph;  // glyph origin in the atlas (px)
+layout(location = 2) in vec4 instanceForeground;
+layout(location = 3) in vec4 instanceBackground;
+
+uniform mat4 mvp;
+uniform vec2 cellSize;
+uniform vec2 atlasSize;
+uniform int columns;
+uniform int rows;
+// 0: background pass, 1: glyph pass
+uniform int pass;
+
+out vec2 fragTexCoord;
+out vec4 fragColor;
+
+void main()
+{
+    // Cells are laid out row by row, the first row at the bottom of the
+    // render texture (it gets y-flipped when drawn to the screen)
+    int column = gl_InstanceID % columns;
+    int row = gl_InstanceID / columns;
+    vec2 origin = vec2(float(column), float(rows - 1 - row)) * cellSize;
+
+    fragTexCoord = (instanceGlyph + vertexCorner * cellSize) / atlasSize;
+    fragColor = (pass == 0) ? instanceBackground : instanceForeground;
+    gl_Position = mvp * vec4(origin + vertexCorner * cellSize, 0.0, 1.0);
+}